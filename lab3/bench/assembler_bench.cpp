@@ -0,0 +1,205 @@
+#include "benchmark.h"
+#include "assembler/assembler.h"
+#include "generator/programgenerator.h"
+#include "parser/charscanner.h"
+#include "parser/parser.h"
+#include <map>
+
+namespace {
+
+// Generated programs are cached per size: the harness calls each benchmark several times
+struct Workload
+{
+    std::string source;
+    std::string addressingMode;
+    std::vector<std::vector<std::string>> sourceLines;
+    std::vector<std::vector<std::string>> firstPassLines;
+    std::vector<std::string> objectRecords;
+};
+
+const Workload& workload(std::int64_t lineCount)
+{
+    static std::map<std::int64_t, Workload> cache;
+
+    auto it = cache.find(lineCount);
+    if (it != cache.end()) return it->second;
+
+    GeneratorOptions options;
+    options.lineCount = static_cast<std::size_t>(lineCount) / 4;
+    options.labelDensity = 0.3;
+    options.forwardReferenceRatio = 0.5;
+    options.relativeRatio = 0.5;
+    options.csectCount = 3;
+    options.extdefCount = 8;
+    options.extrefCount = 8;
+
+    ProgramGenerator generator(options);
+
+    Workload& result = cache[lineCount];
+    result.source = generator.generate();
+    result.addressingMode = generator.getAddressingMode();
+    result.sourceLines = Parser::parseCode(result.source);
+
+    Assembler assembler;
+    std::vector<std::string> firstPass = assembler.firstPass(result.sourceLines, result.addressingMode);
+    std::string firstPassText;
+    for (const auto& line : firstPass) {
+        firstPassText += line + "\n";
+    }
+    result.firstPassLines = Parser::parseCode(firstPassText);
+    result.objectRecords = assembler.secondPass(result.firstPassLines);
+
+    return result;
+}
+
+void BM_Tokenizer(bench::State& state)
+{
+    const Workload& w = workload(state.range(0));
+    for (auto _ : state) {
+        std::vector<std::vector<std::string>> lines = Parser::parseCode(w.source);
+        bench::doNotOptimize(lines);
+    }
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(w.source.size()));
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.sourceLines.size()));
+}
+BENCHMARK(BM_Tokenizer)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_CharScanner(bench::State& state)
+{
+    // Mask kernel alone; the argument is an index into CharScanner::availableKernels()
+    std::vector<CharScanner::KernelInfo> kernels = CharScanner::availableKernels();
+    if (state.range(0) >= static_cast<std::int64_t>(kernels.size())) {
+        state.setLabel("unavailable");
+        for (auto _ : state) {
+        }
+        return;
+    }
+
+    const Workload& w = workload(10000);
+    CharScanner::Kernel kernel = kernels[state.range(0)].kernel;
+    size_t blocks = w.source.size() / CharScanner::BLOCK_SIZE;
+    for (auto _ : state) {
+        std::uint64_t bits = 0;
+        for (size_t i = 0; i < blocks; ++i) {
+            CharScanner::BlockMasks masks = kernel(w.source.data() + i * CharScanner::BLOCK_SIZE);
+            bits += masks.newlines ^ masks.spaces ^ masks.quotes;
+        }
+        bench::doNotOptimize(bits);
+    }
+    state.setLabel(kernels[state.range(0)].name);
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(blocks * CharScanner::BLOCK_SIZE));
+}
+BENCHMARK(BM_CharScanner)->Arg(0)->Arg(1)->Arg(2);
+
+void BM_TokenizerKernel(bench::State& state)
+{
+    // Parser::parseCode with each mask kernel; the scalar one stands for the per-character loop
+    std::vector<CharScanner::KernelInfo> kernels = CharScanner::availableKernels();
+    if (state.range(0) >= static_cast<std::int64_t>(kernels.size())) {
+        state.setLabel("unavailable");
+        for (auto _ : state) {
+        }
+        return;
+    }
+
+    const Workload& w = workload(10000);
+    CharScanner::Kernel defaultKernel = CharScanner::kernel();
+    CharScanner::setKernel(kernels[state.range(0)].kernel);
+    for (auto _ : state) {
+        std::vector<std::vector<std::string>> lines = Parser::parseCode(w.source);
+        bench::doNotOptimize(lines);
+    }
+    CharScanner::setKernel(defaultKernel);
+
+    state.setLabel(kernels[state.range(0)].name);
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(w.source.size()));
+}
+BENCHMARK(BM_TokenizerKernel)->Arg(0)->Arg(1)->Arg(2);
+
+void BM_FirstPass(bench::State& state)
+{
+    const Workload& w = workload(state.range(0));
+    Assembler assembler;
+    for (auto _ : state) {
+        state.pauseTiming();
+        assembler.clearTSI();
+        assembler.clearTN();
+        assembler.clearSections();
+        state.resumeTiming();
+
+        std::vector<std::string> firstPass = assembler.firstPass(w.sourceLines, w.addressingMode);
+        bench::doNotOptimize(firstPass);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.sourceLines.size()));
+}
+BENCHMARK(BM_FirstPass)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_SecondPass(bench::State& state)
+{
+    const Workload& w = workload(state.range(0));
+    Assembler assembler;
+    assembler.firstPass(w.sourceLines, w.addressingMode);
+    for (auto _ : state) {
+        state.pauseTiming();
+        assembler.clearTN();
+        state.resumeTiming();
+
+        std::vector<std::string> objectRecords = assembler.secondPass(w.firstPassLines);
+        bench::doNotOptimize(objectRecords);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.firstPassLines.size()));
+}
+BENCHMARK(BM_SecondPass)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_ObjectEmission(bench::State& state)
+{
+    // Joining the records into the object text, as the UI and a file writer do
+    const Workload& w = workload(state.range(0));
+    std::int64_t bytes = 0;
+    for (auto _ : state) {
+        std::string objectText;
+        for (const auto& record : w.objectRecords) {
+            objectText += record + "\n";
+        }
+        bytes = static_cast<std::int64_t>(objectText.size());
+        bench::doNotOptimize(objectText);
+    }
+    state.setBytesProcessed(state.iterations() * bytes);
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.objectRecords.size()));
+}
+BENCHMARK(BM_ObjectEmission)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_FullAssembly(bench::State& state)
+{
+    // Source text to object records, including re-tokenizing the first pass output
+    const Workload& w = workload(state.range(0));
+    for (auto _ : state) {
+        Assembler assembler;
+        std::vector<std::string> firstPass = assembler.firstPass(Parser::parseCode(w.source), w.addressingMode);
+        std::string firstPassText;
+        for (const auto& line : firstPass) {
+            firstPassText += line + "\n";
+        }
+        std::vector<std::string> objectRecords = assembler.secondPass(Parser::parseCode(firstPassText));
+        bench::doNotOptimize(objectRecords);
+    }
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(w.source.size()));
+}
+BENCHMARK(BM_FullAssembly)->Arg(1000)->Arg(10000)->Arg(100000);
+
+void BM_SinglePassAssembly(bench::State& state)
+{
+    // Source text to the same object records in one pass with backpatching
+    const Workload& w = workload(state.range(0));
+    for (auto _ : state) {
+        Assembler assembler;
+        std::vector<std::string> objectRecords = assembler.assemble(Parser::parseCode(w.source), w.addressingMode);
+        bench::doNotOptimize(objectRecords);
+    }
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(w.source.size()));
+}
+BENCHMARK(BM_SinglePassAssembly)->Arg(1000)->Arg(10000)->Arg(100000);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,259 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Minimal harness with the shape of Google Benchmark:
+//
+//     static void BM_Something(bench::State& state) {
+//         for (auto _ : state) { ... }
+//     }
+//     BENCHMARK(BM_Something)->Arg(1000)->Arg(100000);
+//     BENCHMARK_MAIN();
+//
+// Flags: --benchmark_filter=<substring>, --benchmark_min_time=<seconds>
+// The exit code is 1 if a benchmark called skipWithError().
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class State
+{
+public:
+    State(std::int64_t iterations, std::int64_t argument)
+        : iterations_(iterations), argument_(argument), itemsProcessed_(0), bytesProcessed_(0),
+          paused_(false), pausedTime_(0)
+    {
+    }
+
+    std::int64_t range(int index = 0) const { return index == 0 ? argument_ : 0; }
+    std::int64_t iterations() const { return iterations_; }
+
+    void setItemsProcessed(std::int64_t items) { itemsProcessed_ = items; }
+    void setBytesProcessed(std::int64_t bytes) { bytesProcessed_ = bytes; }
+    void setLabel(const std::string& label) { label_ = label; }
+
+    // Marks the run failed, e.g. when a kernel disagrees with the reference; return without looping
+    void skipWithError(const std::string& message) { error_ = message; }
+    const std::string& error() const { return error_; }
+
+    // Exclude setup inside the timed loop
+    void pauseTiming()
+    {
+        pauseStart_ = Clock::now();
+        paused_ = true;
+    }
+
+    void resumeTiming()
+    {
+        if (paused_) {
+            pausedTime_ += Clock::now() - pauseStart_;
+            paused_ = false;
+        }
+    }
+
+    struct Sentinel {};
+
+    // Non-trivial destructor, so the unused loop variable does not warn
+    struct Value
+    {
+        ~Value() {}
+    };
+
+    class Iterator
+    {
+    public:
+        Iterator(State* state, std::int64_t remaining) : state_(state), remaining_(remaining) {}
+        Value operator*() const { return Value(); }
+        Iterator& operator++() { --remaining_; return *this; }
+        bool operator!=(const Sentinel&)
+        {
+            if (remaining_ > 0) return true;
+            state_->finish();
+            return false;
+        }
+
+    private:
+        State* state_;
+        std::int64_t remaining_;
+    };
+
+    Iterator begin()
+    {
+        start_ = Clock::now();
+        return Iterator(this, iterations_);
+    }
+    Sentinel end() { return Sentinel(); }
+
+    double elapsedSeconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+    std::int64_t itemsProcessed() const { return itemsProcessed_; }
+    std::int64_t bytesProcessed() const { return bytesProcessed_; }
+    const std::string& label() const { return label_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::int64_t iterations_;
+    std::int64_t argument_;
+    std::int64_t itemsProcessed_;
+    std::int64_t bytesProcessed_;
+    std::string label_;
+    std::string error_;
+    bool paused_;
+    Clock::time_point start_;
+    Clock::time_point pauseStart_;
+    Clock::duration pausedTime_;
+    Clock::duration elapsed_{};
+
+    void finish()
+    {
+        resumeTiming();
+        elapsed_ = Clock::now() - start_ - pausedTime_;
+    }
+};
+
+using Function = void (*)(State&);
+
+class Benchmark
+{
+public:
+    Benchmark(const char* name, Function function) : name_(name), function_(function) {}
+
+    Benchmark* Arg(std::int64_t argument)
+    {
+        arguments_.push_back(argument);
+        return this;
+    }
+
+    const std::string& name() const { return name_; }
+    Function function() const { return function_; }
+    const std::vector<std::int64_t>& arguments() const { return arguments_; }
+
+private:
+    std::string name_;
+    Function function_;
+    std::vector<std::int64_t> arguments_;
+};
+
+inline std::vector<Benchmark*>& registry()
+{
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+inline Benchmark* registerBenchmark(const char* name, Function function)
+{
+    registry().push_back(new Benchmark(name, function));
+    return registry().back();
+}
+
+inline std::string formatRate(double perSecond, const char* unit)
+{
+    static const char* const prefixes[] = { "", "k", "M", "G", "T" };
+    int prefix = 0;
+    while (perSecond >= 1000.0 && prefix < 4) {
+        perSecond /= 1000.0;
+        ++prefix;
+    }
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.2f %s%s/s", perSecond, prefixes[prefix], unit);
+    return buffer;
+}
+
+inline int runAll(int argc, char** argv)
+{
+    std::string filter;
+    double minTime = 0.5;
+    bool failed = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--benchmark_filter=", 19) == 0) {
+            filter = argv[i] + 19;
+        } else if (std::strncmp(argv[i], "--benchmark_min_time=", 21) == 0) {
+            minTime = std::atof(argv[i] + 21);
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::printf("%-40s %15s %12s  %s\n", "Benchmark", "Time", "Iterations", "Throughput");
+    std::printf("%s\n", std::string(96, '-').c_str());
+
+    for (const Benchmark* benchmark : registry()) {
+        std::vector<std::int64_t> arguments = benchmark->arguments();
+        if (arguments.empty()) arguments.push_back(0);
+
+        for (std::int64_t argument : arguments) {
+            std::string name = benchmark->name();
+            if (!benchmark->arguments().empty()) name += "/" + std::to_string(argument);
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            // Grow the iteration count until a run takes at least minTime
+            std::int64_t iterations = 1;
+            for (;;) {
+                State state(iterations, argument);
+                benchmark->function()(state);
+                if (!state.error().empty()) {
+                    std::printf("%-40s ERROR: %s\n", name.c_str(), state.error().c_str());
+                    failed = true;
+                    break;
+                }
+                double seconds = state.elapsedSeconds();
+
+                if (seconds >= minTime || iterations >= 1000000000) {
+                    double nsPerIteration = seconds * 1e9 / static_cast<double>(iterations);
+                    std::string throughput;
+                    if (state.bytesProcessed() > 0) {
+                        throughput += formatRate(state.bytesProcessed() / seconds, "B") + " ";
+                    }
+                    if (state.itemsProcessed() > 0) {
+                        throughput += formatRate(state.itemsProcessed() / seconds, "items") + " ";
+                    }
+                    throughput += state.label();
+
+                    std::printf("%-40s %12.0f ns %12lld  %s\n", name.c_str(), nsPerIteration,
+                                static_cast<long long>(iterations), throughput.c_str());
+                    break;
+                }
+
+                double scale = seconds > 0.0 ? minTime * 1.4 / seconds : 10.0;
+                if (scale > 10.0) scale = 10.0;
+                if (scale < 2.0) scale = 2.0;
+                iterations = static_cast<std::int64_t>(static_cast<double>(iterations) * scale);
+            }
+        }
+    }
+
+    return failed ? 1 : 0;
+}
+
+} // namespace bench
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+
+#define BENCHMARK(function) \
+    static ::bench::Benchmark* BENCHMARK_CONCAT(benchmark_, __LINE__) = \
+        ::bench::registerBenchmark(#function, function)
+
+#define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return ::bench::runAll(argc, argv); }
+
+#endif // BENCHMARK_H
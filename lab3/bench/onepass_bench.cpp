@@ -0,0 +1,75 @@
+// Benchmarks of the lab5 one-pass assembler on the same generated programs.
+// Built only when Qt6::Core is available.
+
+#include "benchmark.h"
+#include "assembler/Assembler.h"
+#include "helpers/Parser.h"
+#include "generator/programgenerator.h"
+#include <map>
+
+namespace {
+
+struct Workload
+{
+    QString source;
+    QString addressingMode;
+    QList<QList<QString>> sourceLines;
+    QList<CommandDto> commands;
+};
+
+const Workload& workload(std::int64_t lineCount)
+{
+    static std::map<std::int64_t, Workload> cache;
+
+    auto it = cache.find(lineCount);
+    if (it != cache.end()) return it->second;
+
+    // The one-pass assembler knows neither sections nor external names
+    GeneratorOptions options;
+    options.lineCount = static_cast<std::size_t>(lineCount);
+    options.labelDensity = 0.3;
+    options.forwardReferenceRatio = 0.5;
+    options.relativeRatio = 0.5;
+
+    ProgramGenerator generator(options);
+
+    Workload& result = cache[lineCount];
+    result.source = QString::fromStdString(generator.generate());
+    result.addressingMode = QString::fromStdString(generator.getAddressingMode());
+    result.sourceLines = Parser::ParseCode(result.source);
+    result.commands = Parser::TextToCommandDtos(QString::fromStdString(ProgramGenerator::defaultCommandsText()));
+    return result;
+}
+
+void BM_OnePassTokenizer(bench::State& state)
+{
+    const Workload& w = workload(state.range(0));
+    for (auto _ : state) {
+        QList<QList<QString>> lines = Parser::ParseCode(w.source);
+        bench::doNotOptimize(lines);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.sourceLines.size()));
+}
+BENCHMARK(BM_OnePassTokenizer)->Arg(1000)->Arg(10000);
+
+void BM_OnePass(bench::State& state)
+{
+    const Workload& w = workload(state.range(0));
+    Assembler assembler;
+    assembler.AddressingMode = w.addressingMode;
+    for (auto _ : state) {
+        state.pauseTiming();
+        assembler.Reset(w.sourceLines, w.commands);
+        state.resumeTiming();
+
+        while (!assembler.ProcessStep()) {
+        }
+        bench::doNotOptimize(assembler.BinaryCode);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(w.sourceLines.size()));
+}
+BENCHMARK(BM_OnePass)->Arg(1000)->Arg(10000);
+
+} // namespace
+
+BENCHMARK_MAIN();
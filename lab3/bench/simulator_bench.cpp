@@ -0,0 +1,145 @@
+// Benchmarks of the simulator on assembled loop programs
+
+#include "benchmark.h"
+#include "assembler/assembler.h"
+#include "parser/parser.h"
+#include "simulator/loader.h"
+#include "simulator/simulator.h"
+#include <map>
+#include <memory>
+
+namespace {
+
+const std::uint64_t INSTRUCTIONS_PER_ITERATION = 1000000;
+
+// Endless loop: load two words, the argument number of register additions, store, jump back
+const ObjectProgram& loopProgram(std::int64_t additions)
+{
+    static std::map<std::int64_t, ObjectProgram> cache;
+
+    auto it = cache.find(additions);
+    if (it != cache.end()) return it->second;
+
+    std::string source = "PROG START 0\n"
+                         "LOOP LOADR1 X\n"
+                         "     LOADR2 Y\n";
+    for (std::int64_t i = 0; i < additions; ++i) {
+        source += "     ADD R1 R2\n";
+    }
+    source += "     SAVER1 X\n"
+              "     JMP [LOOP]\n"
+              "X    WORD 5\n"
+              "Y    WORD 1\n"
+              "     END\n";
+
+    Assembler assembler;
+    std::vector<std::string> records = assembler.assemble(Parser::parseCode(source), AddressingMode::MIXED);
+    return cache.emplace(additions, ObjectProgram::parse(records)).first->second;
+}
+
+const SemanticsTable& defaultSemantics()
+{
+    static const SemanticsTable semantics(*Assembler().getCommandTable());
+    return semantics;
+}
+
+void runLoop(bench::State& state, bool blocks, bool jit)
+{
+    std::unique_ptr<Simulator> simulator(new Simulator(defaultSemantics()));
+    simulator->setBlockCacheEnabled(blocks);
+    simulator->setJitEnabled(jit);
+    simulator->load(loopProgram(state.range(0)), 0x1000);
+
+    for (auto _ : state) {
+        Simulator::StopReason reason = simulator->run(INSTRUCTIONS_PER_ITERATION);
+        bench::doNotOptimize(reason);
+    }
+    state.setItemsProcessed(state.iterations() * static_cast<std::int64_t>(INSTRUCTIONS_PER_ITERATION));
+    state.setLabel("instructions");
+}
+
+void BM_SimulatorLoop(bench::State& state)
+{
+    runLoop(state, true, false);
+}
+BENCHMARK(BM_SimulatorLoop)->Arg(0)->Arg(8)->Arg(64);
+
+// Same loops dispatched one command at a time
+void BM_SimulatorLoopNoBlocks(bench::State& state)
+{
+    runLoop(state, false, false);
+}
+BENCHMARK(BM_SimulatorLoopNoBlocks)->Arg(0)->Arg(8)->Arg(64);
+
+// Same loops compiled to native code where the JIT is available
+void BM_SimulatorLoopJit(bench::State& state)
+{
+    if (!Simulator::isJitAvailable()) {
+        state.setLabel("unavailable");
+        for (auto _ : state) {
+        }
+        return;
+    }
+    runLoop(state, true, true);
+}
+BENCHMARK(BM_SimulatorLoopJit)->Arg(0)->Arg(8)->Arg(64);
+
+void BM_SimulatorLoad(bench::State& state)
+{
+    std::unique_ptr<Simulator> simulator(new Simulator(defaultSemantics()));
+    const ObjectProgram& program = loopProgram(state.range(0));
+
+    for (auto _ : state) {
+        const LoadedProgram& loaded = simulator->load(program, 0x1000);
+        bench::doNotOptimize(loaded.entryAddress);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SimulatorLoad)->Arg(64);
+
+// Programs loaded side by side; the label shows the memory pages each one holds
+void BM_SimulatorMany(bench::State& state)
+{
+    const ObjectProgram& program = loopProgram(8);
+    size_t footprint = 0;
+
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<Simulator>> simulators;
+        for (std::int64_t i = 0; i < state.range(0); ++i) {
+            simulators.emplace_back(new Simulator(defaultSemantics()));
+            simulators.back()->load(program, static_cast<int>(i * 0x1000 % 0x800000));
+            simulators.back()->run(1000);
+        }
+        footprint = simulators.back()->getMemory().getFootprint();
+        bench::doNotOptimize(simulators);
+    }
+    state.setItemsProcessed(state.iterations() * state.range(0));
+    state.setLabel(std::to_string(footprint) + " B of memory per program");
+}
+BENCHMARK(BM_SimulatorMany)->Arg(2000);
+
+// Image of a program with the argument number of relocated commands
+void BM_LoaderRelocation(bench::State& state)
+{
+    std::string source = "PROG START 0\n";
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        source += "     LOADR1 X\n";
+    }
+    source += "X    WORD 5\n"
+              "     END\n";
+    Assembler assembler;
+    ObjectProgram program = ObjectProgram::parse(assembler.assemble(Parser::parseCode(source), AddressingMode::MIXED));
+
+    std::vector<uint8_t> image;
+    for (auto _ : state) {
+        const LoadedProgram loaded = Loader::loadImage(program, image, 0x1000);
+        bench::doNotOptimize(loaded.length);
+        bench::doNotOptimize(image);
+    }
+    state.setBytesProcessed(state.iterations() * static_cast<std::int64_t>(image.size()));
+}
+BENCHMARK(BM_LoaderRelocation)->Arg(100000);
+
+} // namespace
+
+BENCHMARK_MAIN();
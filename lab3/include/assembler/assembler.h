@@ -4,14 +4,26 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include "assembler/commandtable.h"
+#include "assembler/directive.h"
+#include "assembler/listingwriter.h"
+#include "assembler/tokenclassifier.h"
 #include "structures/command.h"
 #include "structures/symbolicname.h"
+#include "structures/symboltable.h"
 #include "structures/codeline.h"
+#include "structures/crossreference.h"
 #include "structures/section.h"
+#include "structures/sectiontable.h"
+#include "structures/linetable.h"
 #include "structures/tnline.h"
 #include "exceptions/assemblerexception.h"
 #include "parser/parser.h"
 
+// Two-pass assembler with a one-pass mode
 class Assembler
 {
 public:
@@ -19,15 +31,26 @@ public:
 
     // Available commands management
     void setAvailableCommands(const std::vector<Command>& commands);
-    const std::vector<Command>& getAvailableCommands() const { return availableCommands_; }
+    void setCommandTable(std::shared_ptr<const CommandTable> commandTable); // Already validated, e.g. from CommandTable::fromText
+    const std::vector<Command>& getAvailableCommands() const { return commandTable_->getCommands(); }
+    const std::shared_ptr<const CommandTable>& getCommandTable() const { return commandTable_; }
 
-    // Two-pass assembly
-    std::vector<std::string> firstPass(const std::vector<std::vector<std::string>>& lines, const std::string& addressingMode = "Straight");
+    // Two-pass assembly. For large programs the first pass runs chunks of lines on
+    // worker threads; tables and errors are the same as in the serial pass.
+    std::vector<std::string> firstPass(const std::vector<std::vector<std::string>>& lines, AddressingMode addressingMode = AddressingMode::STRAIGHT);
+    std::vector<std::string> firstPass(const std::vector<std::vector<std::string>>& lines, const std::string& addressingMode); // See addressingModeFromName
     std::vector<std::string> secondPass(const std::vector<std::vector<std::string>>& firstPassCode);
 
+    // One-pass assembly: object records are emitted while the source is read and forward
+    // references are backpatched. Produces the same records, tables and errors as
+    // firstPass followed by secondPass on its output. Clears TSI, TN and sections first.
+    std::vector<std::string> assemble(const std::vector<std::vector<std::string>>& lines, AddressingMode addressingMode = AddressingMode::STRAIGHT);
+    std::vector<std::string> assemble(const std::vector<std::vector<std::string>>& lines, const std::string& addressingMode); // See addressingModeFromName
+
     // Symbol table management
     void clearTSI();
-    const std::vector<SymbolicName>& getTSI() const { return tsi_; }
+    std::vector<SymbolicName> getTSI() const; // Copy of the entries, in order
+    const SymbolTable& getSymbolTable() const { return tsi_; }
     
     // Modification table management
     void clearTN();
@@ -35,7 +58,29 @@ public:
     
     // Section management
     void clearSections();
-    const std::vector<Section>& getSections() const { return sections_; }
+    const std::vector<Section>& getSections() const { return sections_.getSections(); }
+    const SectionTable& getSectionTable() const { return sections_; }
+
+    // Addresses of the lines of the last firstPass or assemble
+    const LineTable& getLineTable() const { return lineTable_; }
+
+    // Source line numbers of the parsed lines, as returned by Parser::parseCode; the line
+    // table, L records and cross-reference hold these. Empty (the default) numbers parsed line i as i + 1.
+    void setLineNumbers(std::vector<size_t> lineNumbers) { lineNumbers_ = std::move(lineNumbers); }
+
+    // Definition and use sites of the symbols of getSymbolTable() after the last firstPass
+    // or assemble: labels, EXTREF names and EXTDEF, command and relative operands,
+    // forward uses included. Symbols are TSI indexes; uses of unknown names are left out.
+    const CrossReference& getCrossReference() const { return crossReference_; }
+
+    // Off by default. On, each section ends with an L record of its line table
+    // entries, encoded by LineTable::encode, right before the E record.
+    void setLineRecordsEnabled(bool enabled) { lineRecords_ = enabled; }
+    bool isLineRecordsEnabled() const { return lineRecords_; }
+
+    // secondPass writes each line to the listing as it is translated and the symbols
+    // at the end. Not owned; nullptr (the default) writes no listing.
+    void setListing(ListingWriter* listing) { listing_ = listing; }
 
     // Utility functions
     bool isCommand(const std::string& name) const;
@@ -47,54 +92,174 @@ public:
     bool isRelativeLabel(const std::string& str) const;
 
     int getRegisterNumber(const std::string& reg) const;
-    SymbolicName* getSymbolicName(const std::string& name, const std::string& section);
+    std::optional<SymbolicName> getSymbolicName(const std::string& name, const std::string& section) const;
     std::string convertToASCII(const std::string& str) const;
 
 private:
     static const int MAX_ADDRESS = 16777215; // 2^24 - 1
+    static const size_t PARALLEL_MIN_LINES = 2048;  // Smaller programs are not worth the threads
+    static const size_t PARALLEL_CHUNK_LINES = 1024; // Lines per first pass task
 
-    std::vector<Command> availableCommands_;
-    std::vector<SymbolicName> tsi_;
+    std::shared_ptr<const CommandTable> commandTable_;
+    TokenClassifier tokens_; // Classes of tokens seen with commandTable_
+    SymbolTable tsi_;
     std::vector<TNLine> tn_; // Modification table
-    std::vector<Section> sections_;
+    SectionTable sections_;
     Section currentSection_;
+    size_t sectionIndex_; // Of currentSection_ in sections_, which gets it at CSECT or END
+    LineTable lineTable_;
+    std::vector<size_t> lineNumbers_;
+    CrossReference crossReference_;
+    bool lineRecords_;
+    ListingWriter* listing_;
 
     int ip_; // instruction pointer
     int secondIp_; // Second pass instruction pointer
 
-    // Available directives
-    static const std::vector<std::string> AVAILABLE_DIRECTIVES;
+    // Source line after the first pass checks. Formatted as a first pass line
+    // in two-pass mode or as object records in one-pass mode.
+    struct TranslatedLine
+    {
+        enum Kind { START_LINE, CSECT_LINE, EXTDEF_LINE, EXTREF_LINE, WORD_LINE, BYTE_LINE, RESB_LINE, RESW_LINE, COMMAND_LINE, END_LINE };
+        enum OperandKind { NO_OPERAND, REGISTERS, BYTE_VALUE, ADDRESS_VALUE, LABEL, RELATIVE_LABEL, STRING };
+
+        CodeLine codeLine;
+        Kind kind = END_LINE;
+        OperandKind operandKind = NO_OPERAND;
+        int address = 0; // ip_ before the line
+        int opcode = 0;  // Command code * 4 + addressing type
+        int value = 0;   // Numeric operand, START address or CSECT entry address
+        int length = 0;  // Bytes of a BYTE string
+    };
+
+    struct FirstPassState
+    {
+        Directive previousDirective = Directive::NONE; // Of the previous line; NONE after a machine command
+        bool startFlag = false;
+        bool endFlag = false;
+        bool firstMeaningfulLine = true;
+    };
+
+    // First pass of a run of lines of one section, made by a separate assembler.
+    // Chunks after the first one of a section count addresses from zero.
+    struct FirstPassChunk
+    {
+        size_t section = 0;    // Index of the section
+        size_t begin = 0;
+        size_t end = 0;
+        bool startsSection = false; // Begins with START or CSECT
+        std::vector<TranslatedLine> lines;
+        std::vector<std::string> firstPassCode;
+        SymbolTable tsi;
+        std::vector<std::vector<size_t>> shards; // Indexes into tsi by name hash
+        std::vector<char> merged;                // Entry defines an EXTDEF name of another chunk
+        Section currentSection;
+        int ip = 0;
+        int offset = 0;        // Address of the first line minus its address in the chunk
+        bool endFlag = false;
+        bool failed = false;
+    };
+
+    // Record waiting for the address of a symbol; fixups of one symbol form a chain
+    struct Fixup
+    {
+        enum Kind { DIRECT, RELATIVE, DEFINITION };
+
+        Kind kind;
+        size_t record;  // Index of the record whose last 6 digits are patched
+        size_t line;    // Source line, for diagnostics
+        int base;       // Address after the instruction, for relative offsets
+        int next;       // Previous fixup of the same symbol, -1 ends the chain
+    };
+
+    struct OnePassState : FirstPassState
+    {
+        std::vector<std::string> records;
+        std::vector<Fixup> fixups;
+        std::unordered_map<LabelKey, int, LabelKey::Hash> fixupChains; // Name -> last fixup
+        size_t headerRecord = 0;
+        size_t sectionTN = 0; // First TN entry of the current section
+
+        // Second pass errors are reported after the whole first pass, earliest line first
+        size_t errorLine = 0;
+        std::string errorMessage;
+    };
 
     // Helper functions
     void overflowCheck(int value, const std::string& textLine) const;
-    void pushToTSI(const std::string& name, int address, const std::string& section, const std::string& type, const std::string& textLine);
+    void pushToTSI(const std::string& name, int address, size_t section, SymbolicName::Kind kind, const std::string& textLine);
     void pushToTN(const std::string& address, const std::string& label, const std::string& section);
+    SymbolicName symbolicName(size_t index) const; // TSI entry with the name of its section
     void addSection(const Section& section);
     void tsiCheck();
-    void orderCheck(const std::string& directive, const std::string& previousCommand, const std::string& textLine);
+    void orderCheck(Directive directive, Directive previousDirective, const std::string& textLine);
+    void addToLineTable(const TranslatedLine& line, size_t lineIndex, size_t section);
+    size_t sourceLineNumber(size_t lineIndex) const { return lineIndex < lineNumbers_.size() ? lineNumbers_[lineIndex] : lineIndex + 1; }
+
+    // Sites of a name not in the TSI yet, resolved when the pass ends
+    struct ForwardSite
+    {
+        size_t site;
+        size_t section;
+        std::string name;
+    };
+
+    void addToCrossReference(const TranslatedLine& line, size_t lineIndex, size_t section,
+                             std::vector<ForwardSite>& forwardSites);
+    void addSite(const std::string& name, size_t lineIndex, bool definition, size_t section,
+                 std::vector<ForwardSite>& forwardSites);
+    void buildCrossReference(const std::vector<ForwardSite>& forwardSites);
+    void pushLineRecord(size_t section, std::vector<std::string>& records) const; // If enabled and the section has lines
 
     CodeLine getCodeLineFromSource(const std::vector<std::string>& line);
     CodeLine getCodeLineFromFirstPass(const std::vector<std::string>& line);
 
     // First pass processing
-    std::string processStartDirective(const CodeLine& codeLine, const std::string& textLine, bool& startFlag);
-    std::string processCsectDirective(const CodeLine& codeLine, const std::string& textLine);
-    std::string processExtdefDirective(const CodeLine& codeLine, const std::string& textLine, const std::string& previousCommand);
-    std::string processExtrefDirective(const CodeLine& codeLine, const std::string& textLine, const std::string& previousCommand);
-    std::string processWordDirective(const CodeLine& codeLine, const std::string& textLine);
-    std::string processByteDirective(const CodeLine& codeLine, const std::string& textLine);
-    std::string processReswDirective(const CodeLine& codeLine, const std::string& textLine);
-    std::string processResbDirective(const CodeLine& codeLine, const std::string& textLine);
-    std::string processEndDirective(const CodeLine& codeLine, const std::string& textLine);
+    TranslatedLine translateLine(const std::vector<std::string>& line, AddressingMode addressingMode, FirstPassState& state);
+    std::string formatFirstPassLine(const TranslatedLine& line) const;
+    void processStartDirective(TranslatedLine& line, const std::string& textLine, bool& startFlag);
+    void processCsectDirective(TranslatedLine& line, const std::string& textLine);
+    void processExtdefDirective(TranslatedLine& line, const std::string& textLine, Directive previousDirective);
+    void processExtrefDirective(TranslatedLine& line, const std::string& textLine, Directive previousDirective);
+    void processWordDirective(TranslatedLine& line, const std::string& textLine);
+    void processByteDirective(TranslatedLine& line, const std::string& textLine);
+    void processReswDirective(TranslatedLine& line, const std::string& textLine);
+    void processResbDirective(TranslatedLine& line, const std::string& textLine);
+    void processEndDirective(TranslatedLine& line, const std::string& textLine);
+    void processCommand(TranslatedLine& line, const std::string& textLine, AddressingMode addressingMode);
+
+    // Parallel first pass
+    std::vector<size_t> findSectionBounds(const std::vector<std::vector<std::string>>& lines) const;
+    bool parallelFirstPass(const std::vector<std::vector<std::string>>& lines, const std::vector<size_t>& bounds,
+                           AddressingMode addressingMode, std::vector<std::string>& firstPassCode);
+    void firstPassChunk(const std::vector<std::vector<std::string>>& lines, const std::string& sectionName,
+                        AddressingMode addressingMode, size_t shardCount, FirstPassChunk& chunk) const;
+    bool mergeChunkSymbols(std::vector<FirstPassChunk>& chunks, size_t shard, size_t sectionCount) const;
+
+    // One-pass processing
+    void emitRecords(const TranslatedLine& line, size_t lineIndex, OnePassState& state);
+    void emitCommandRecord(const TranslatedLine& line, size_t lineIndex, OnePassState& state);
+    void emitSymbolReference(const std::string& name, Fixup::Kind kind, size_t lineIndex, OnePassState& state);
+    void resolveFixups(const std::string& name, int address, OnePassState& state);
+    void closeSectionRecords(size_t lineIndex, const std::vector<std::vector<std::string>>& lines, OnePassState& state);
+    void deferError(size_t lineIndex, const std::string& message, OnePassState& state);
+
+    // T record with the code it holds, which the listing shows
+    struct TextRecord
+    {
+        std::string record;
+        std::string code; // Hex, empty for RESB and RESW
+    };
 
     // Second pass processing
+    static TextRecord textRecord(const CodeLine& codeLine, int length, std::string code, char separator);
     std::string processSecondPassExtdef(const CodeLine& codeLine, const std::string& textLine);
     std::string processSecondPassExtref(const CodeLine& codeLine, const std::string& textLine);
-    std::string processSecondPassWord(const CodeLine& codeLine);
-    std::string processSecondPassByte(const CodeLine& codeLine);
-    std::string processSecondPassResb(const CodeLine& codeLine);
-    std::string processSecondPassResw(const CodeLine& codeLine);
-    std::string processSecondPassCommand(const CodeLine& codeLine, const std::string& textLine);
+    TextRecord processSecondPassWord(const CodeLine& codeLine);
+    TextRecord processSecondPassByte(const CodeLine& codeLine);
+    TextRecord processSecondPassResb(const CodeLine& codeLine);
+    TextRecord processSecondPassResw(const CodeLine& codeLine);
+    TextRecord processSecondPassCommand(const CodeLine& codeLine, const std::string& textLine);
 };
 
 #endif // ASSEMBLER_H
@@ -0,0 +1,41 @@
+#ifndef COMMANDTABLE_H
+#define COMMANDTABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "structures/command.h"
+#include "structures/labelkey.h"
+
+// Validated set of machine commands with lookups by name and by code.
+// Tables are immutable, so one table can be shared by several assemblers.
+class CommandTable
+{
+public:
+    // Checks name and code uniqueness
+    explicit CommandTable(const std::vector<Command>& commands);
+
+    // Parses and validates a command table text. The result is cached by the
+    // content hash, so an unchanged text is neither parsed nor validated again.
+    static std::shared_ptr<const CommandTable> fromText(const std::string& text);
+
+    // 64-bit FNV-1a hash of the text
+    static uint64_t contentHash(std::string_view text);
+
+    const std::vector<Command>& getCommands() const { return commands_; }
+
+    // Case-insensitive; nullptr if there is no such command
+    const Command* findByName(const std::string& name) const;
+    const Command* findByCode(int code) const;
+
+private:
+    std::vector<Command> commands_;
+    std::unordered_map<LabelKey, size_t, LabelKey::Hash> indexByKey_; // Names that fit a LabelKey
+    std::unordered_map<std::string, size_t> indexByName_;           // Longer names, upper-case
+    std::unordered_map<int, size_t> indexByCode_;
+};
+
+#endif // COMMANDTABLE_H
@@ -0,0 +1,18 @@
+#ifndef DIRECTIVE_H
+#define DIRECTIVE_H
+
+#include <string>
+
+// Assembler directives; NONE for machine commands and unknown names
+enum class Directive { NONE, START, END, WORD, BYTE, RESB, RESW, EXTDEF, EXTREF, CSECT };
+
+// Case-insensitive, without allocations
+Directive directiveFromName(const std::string& name);
+
+// Which label operands a program may use: LABEL (Straight), [LABEL] (Relative) or both (Mixed)
+enum class AddressingMode { STRAIGHT, RELATIVE, MIXED };
+
+// "Straight", "Relative" or "Mixed" as the UI and the command line spell them; other names allow both kinds
+AddressingMode addressingModeFromName(const std::string& name);
+
+#endif // DIRECTIVE_H
@@ -0,0 +1,47 @@
+#ifndef LISTINGWRITER_H
+#define LISTINGWRITER_H
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "structures/crossreference.h"
+#include "structures/sectiontable.h"
+#include "structures/symboltable.h"
+
+// Assembly listing: every source line with its number, address and generated
+// bytes, then a cross-reference of the symbols. Lines are written to the stream
+// as the second pass translates them; only a position in the source is kept.
+class ListingWriter
+{
+public:
+    static const size_t BYTES_PER_LINE = 8; // Longer code goes on continuation lines
+
+    // source and lineNumbers are those given to and returned by Parser::parseCode;
+    // lineNumbers is empty if no lines were skipped. Both must outlive the writer.
+    ListingWriter(std::ostream& out, std::string_view source, const std::vector<size_t>& lineNumbers);
+
+    // Parsed line with its address, -1 if it has none, and code in hex. Source lines
+    // before it that were not given yet are written without code. Lines come in order.
+    void writeLine(size_t line, int address, std::string_view code);
+
+    // Writes the rest of the source, then the symbols by name with the source lines
+    // of their sites (the assembler must have the same lineNumbers); definitions are
+    // marked with '*'. Symbols name their sections by
+    // indexes into sections.
+    void finish(const SymbolTable& symbols, const SectionTable& sections, const CrossReference& crossReference);
+
+private:
+    size_t sourceLine(size_t line) const; // 0-based
+
+    void writeSourceLine(std::string_view code, int address); // The next line of the source
+    void writeText(int address, std::string_view code, size_t number, std::string_view text);
+
+    std::ostream& out_;
+    std::string_view source_;
+    const std::vector<size_t>& lineNumbers_;
+    size_t position_;   // Start of the next source line
+    size_t nextLine_;   // Its 0-based number
+};
+
+#endif // LISTINGWRITER_H
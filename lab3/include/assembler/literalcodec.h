@@ -0,0 +1,22 @@
+#ifndef LITERALCODEC_H
+#define LITERALCODEC_H
+
+#include <cstddef>
+#include <string>
+
+// Checks and encodes the contents of C"..." and X"..." literals of BYTE.
+// Pass 1 uses the checks, pass 2 and one-pass mode the encoding.
+class LiteralCodec
+{
+public:
+    // Every byte is printable ASCII (32-126), as C"..." requires
+    static bool isPrintable(const char* data, size_t size);
+
+    // Every byte is a hex digit, as X"..." requires
+    static bool isHexDigits(const char* data, size_t size);
+
+    // Appends two upper-case hex digits per byte
+    static void encodeHex(const char* data, size_t size, std::string& out);
+};
+
+#endif // LITERALCODEC_H
@@ -0,0 +1,49 @@
+#ifndef TOKENCLASSIFIER_H
+#define TOKENCLASSIFIER_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "assembler/commandtable.h"
+#include "assembler/directive.h"
+
+// Everything the assembler checks about a token. A token can be several things
+// at once, e.g. a number and the name of a command.
+struct TokenClass
+{
+    bool label = false;         // Can be defined in the TSI: not a register, command or directive
+    bool relativeLabel = false; // [LABEL]
+    bool cString = false;       // C"..." of printable characters
+    bool xString = false;       // X"..." of an even number of hex digits
+    bool number = false;        // Accepted by std::stoi (a leading decimal int), the value is in value
+    int value = 0;
+    int registerNumber = 0;     // 1-16 for R1-R16, 0 for other tokens
+    const Command* command = nullptr; // Machine command of this name
+    Directive directive = Directive::NONE;
+};
+
+// Classifies tokens against one command table and keeps the results of one
+// assembly, so a token is classified once however many lines and passes use it.
+// At most MAX_CACHED results are kept; the cache starts over when it is full.
+// Not thread-safe.
+class TokenClassifier
+{
+public:
+    static const size_t MAX_CACHED = 16384;
+
+    TokenClassifier(); // Knows no commands
+    explicit TokenClassifier(std::shared_ptr<const CommandTable> commandTable);
+
+    // By value, so a class stays valid when the cache starts over
+    TokenClass classify(const std::string& token) const;
+
+    void clear() { classes_.clear(); } // At the start of an assembly
+
+private:
+    TokenClass compute(const std::string& token) const;
+
+    std::shared_ptr<const CommandTable> commandTable_;
+    mutable std::unordered_map<std::string, TokenClass> classes_;
+};
+
+#endif // TOKENCLASSIFIER_H
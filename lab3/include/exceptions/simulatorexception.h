@@ -0,0 +1,15 @@
+#ifndef SIMULATOREXCEPTION_H
+#define SIMULATOREXCEPTION_H
+
+#include <stdexcept>
+#include <string>
+
+// Malformed object programs and load errors
+class SimulatorException : public std::runtime_error
+{
+public:
+    SimulatorException();
+    SimulatorException(const std::string& message);
+};
+
+#endif // SIMULATOREXCEPTION_H
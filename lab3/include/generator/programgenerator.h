@@ -0,0 +1,69 @@
+#ifndef PROGRAMGENERATOR_H
+#define PROGRAMGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parameters of a synthetic program. Ratios are in the range [0, 1].
+struct GeneratorOptions
+{
+    std::size_t lineCount = 1000;        // Instruction and data lines per section
+    double labelDensity = 0.3;           // Share of lines that define a label
+    double forwardReferenceRatio = 0.5;  // Share of label operands that refer to a later line
+    double relativeRatio = 0.0;          // Share of label operands written as [LABEL]
+    double dataRatio = 0.2;              // Share of lines that are BYTE/WORD/RESB/RESW
+
+    // Relative weights of the data directives
+    int byteWeight = 4;
+    int wordWeight = 3;
+    int resbWeight = 2;
+    int reswWeight = 1;
+
+    std::size_t csectCount = 0;          // Sections after the START one
+    std::size_t extdefCount = 0;         // EXTDEF directives per section
+    std::size_t extrefCount = 0;         // EXTREF directives per section (needs csectCount > 0)
+
+    std::uint64_t seed = 1;
+};
+
+// Generates valid source programs for the default command table.
+// Programs without sections and external names are also accepted by the one-pass assembler (lab5).
+class ProgramGenerator
+{
+public:
+    explicit ProgramGenerator(const GeneratorOptions& options = GeneratorOptions());
+
+    std::string generate();
+
+    // Addressing mode the generated program needs: "Straight", "Relative" or "Mixed"
+    std::string getAddressingMode() const;
+
+    // Default command table in the format accepted by Parser::textToCommands
+    static std::string defaultCommandsText();
+
+private:
+    struct PlannedLine
+    {
+        int kind;
+        int label;     // Index into the section labels, -1 if none
+        int length;
+    };
+
+    GeneratorOptions options_;
+    std::uint64_t state_;
+    int nextLabel_;
+
+    std::uint64_t next();
+    std::size_t nextIndex(std::size_t bound);
+    int nextInt(int min, int max);
+    bool chance(double ratio);
+
+    static std::string labelName(int index);
+    std::string labelOperand(const std::string& name);
+    std::string cString(int length);
+    std::string xString(int bytes);
+};
+
+#endif // PROGRAMGENERATOR_H
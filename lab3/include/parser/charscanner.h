@@ -0,0 +1,43 @@
+#ifndef CHARSCANNER_H
+#define CHARSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Classifies the characters the tokenizer looks for, 64 bytes at a time.
+// Bit i of a mask stands for byte i of the block.
+class CharScanner
+{
+public:
+    static const size_t BLOCK_SIZE = 64;
+
+    struct BlockMasks
+    {
+        uint64_t newlines; // '\n'
+        uint64_t spaces;   // ' ', '\t', '\r', '\v', '\f' (the \S whitespace of a line)
+        uint64_t quotes;   // '"'
+    };
+
+    using Kernel = BlockMasks (*)(const char* block);
+
+    struct KernelInfo
+    {
+        std::string name;
+        Kernel kernel;
+    };
+
+    // Widest kernel this CPU supports: AVX2, SSE2 or scalar
+    static Kernel kernel();
+
+    // Kernels this CPU can run, scalar first; for benchmarks and checks
+    static std::vector<KernelInfo> availableKernels();
+
+    // Replaces the kernel used by Parser; for benchmarks and checks, not thread-safe
+    static void setKernel(Kernel kernel);
+
+    static BlockMasks scanBlockScalar(const char* block);
+};
+
+#endif // CHARSCANNER_H
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include "structures/codeline.h"
 #include "structures/command.h"
 #include "exceptions/assemblerexception.h"
@@ -10,8 +11,10 @@
 class Parser
 {
 public:
-    // Parse source code into lines of tokens
-    static std::vector<std::vector<std::string>> parseCode(const std::string& input);
+    // Parse source code into lines of tokens; input can be a mapped file (see io/mappedfile.h).
+    // Empty lines are skipped; lineNumbers, if given, receives the 1-based source line of every result line.
+    // Large inputs are split at line ends and tokenized on worker threads.
+    static std::vector<std::vector<std::string>> parseCode(std::string_view input, std::vector<size_t>* lineNumbers = nullptr);
 
     // Parse command definitions from text
     static std::vector<Command> textToCommands(const std::string& text);
@@ -22,9 +25,14 @@ public:
     // Parse first pass result line
     static CodeLine parseFirstPassLine(const std::vector<std::string>& line);
 
+    // 1-16 for the registers R1-R16, 0 for other tokens
+    static int registerNumber(const std::string& token);
+
 private:
+    static const size_t PARALLEL_MIN_BYTES = 1 << 20; // Smaller sources are not worth the threads
+
     // Helper functions
-    static std::vector<std::string> tokenizeLine(const std::string& line);
+    static size_t parseLines(std::string_view input, size_t firstLine, std::vector<std::vector<std::string>>& lines, std::vector<size_t>* lineNumbers);
     static bool isValidCommandFormat(const std::vector<std::string>& line);
     static bool isCommandOrDirective(const std::string& token);
     static bool isRegister(const std::string& token);
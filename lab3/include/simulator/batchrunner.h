@@ -0,0 +1,71 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "assembler/commandtable.h"
+#include "assembler/directive.h"
+#include "simulator/semantics.h"
+#include "simulator/simulator.h"
+
+struct BatchOptions
+{
+    uint64_t maxInstructions = 100000000; // Per program, over all its interrupts
+    AddressingMode addressingMode = AddressingMode::STRAIGHT; // Of the sources
+    std::shared_ptr<const CommandTable> commandTable;          // Default commands if null
+    int loadAddress = -1; // See Loader::load
+    bool jit = false;
+    bool profile = false; // Fill BatchResult::profile; compiled blocks are not used then
+};
+
+struct BatchResult
+{
+    enum Status { HALTED, LIMIT_REACHED, FAULT, ERROR };
+
+    std::string path;
+    Status status = ERROR;
+    std::string error;           // Why the program could not be assembled or loaded
+    uint64_t instructions = 0;
+    uint32_t interrupts = 0;     // The simulator resumes after each one
+    double seconds = 0;          // Simulation only
+    uint64_t registerDigest = 0; // FNV-1a of the registers and the instruction pointer
+    uint64_t memoryDigest = 0;   // Memory::digest after the run
+    std::string profile;         // Annotated listing if the source is known, then the flat profile
+
+    double mips() const { return seconds > 0 ? instructions / seconds / 1e6 : 0; }
+};
+
+// Runs many programs on the threads of parallelFor, each in its own Simulator
+// with its own registers and sparse memory. A path ending with .obj is read as
+// object records; any other file is a source, assembled in one pass by the
+// sectioned assembler.
+class BatchRunner
+{
+public:
+    explicit BatchRunner(const BatchOptions& options);
+
+    // Programs of the directory in name order: sources (.asm, .s) and objects (.obj);
+    // other files, such as .prof and .lst output, are skipped. A source is left out when its
+    // <source>.obj, as written by AssemblerCli, is at least as new; otherwise the object is.
+    static std::vector<std::string> listPrograms(const std::string& directory);
+
+    // Results in the order of the paths; errors of one program do not stop the others
+    std::vector<BatchResult> run(const std::vector<std::string>& paths) const;
+    BatchResult runProgram(const std::string& path) const;
+
+    // One line per program, then the totals; wallSeconds is the time of the whole batch
+    static std::string formatReport(const std::vector<BatchResult>& results, double wallSeconds);
+
+private:
+    // When profiling, sources are assembled with L records and give their text; objects
+    // with L records give the text of the source next to them, if any.
+    ObjectProgram readProgram(const std::string& path, std::string& source) const;
+
+    BatchOptions options_;
+    std::shared_ptr<const CommandTable> commandTable_; // options_.commandTable or the default one
+    SemanticsTable semantics_;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,44 @@
+#ifndef CODEBUFFER_H
+#define CODEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Executable memory for generated machine code. The buffer is either writable
+// or executable, never both: code is appended between beginWrite and endWrite
+// and may be called only after endWrite. Available on Linux only.
+class CodeBuffer
+{
+public:
+    explicit CodeBuffer(size_t capacity);
+    ~CodeBuffer();
+
+    CodeBuffer(const CodeBuffer&) = delete;
+    CodeBuffer& operator=(const CodeBuffer&) = delete;
+
+    static bool isSupported();
+    bool isValid() const { return data_ != nullptr; } // The mapping succeeded
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    size_t available() const { return capacity_ - size_; }
+
+    bool beginWrite(); // Makes the buffer writable; false if the protection cannot change
+    void endWrite();   // Makes it executable again
+
+    void emit8(uint8_t value) { data_[size_++] = value; }
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    void patch32(size_t offset, uint32_t value); // Rewrites 4 bytes of emitted code
+
+    // Drops all code; the caller must not keep pointers into it
+    void clear() { size_ = 0; }
+
+private:
+    uint8_t* data_;
+    size_t size_;
+    size_t capacity_;
+};
+
+#endif // CODEBUFFER_H
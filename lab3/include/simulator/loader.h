@@ -0,0 +1,40 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <string>
+#include <vector>
+#include "simulator/memory.h"
+#include "simulator/objectprogram.h"
+#include "structures/linetable.h"
+#include "structures/sectiontable.h"
+
+// Result of loading an object program
+struct LoadedProgram
+{
+    int loadAddress = 0;  // Address of the first section
+    int length = 0;       // Total length of the sections
+    int entryAddress = 0; // E record of the first section, relocated
+    SectionTable sections; // Section offsets from loadAddress
+    LineTable lineTable;   // Decoded L records, addresses as written; empty without them
+};
+
+// Linking loader: places the sections one after another, resolves R names
+// through the D records of all sections and applies the M records.
+//
+// The program is built as one image first. Fields of M records without an
+// external name are collected per section, sorted and moved by the section
+// delta by Relocator, so the image is read and written once.
+class Loader
+{
+public:
+    // A negative loadAddress loads the program at the START address of its first section.
+    // Throws SimulatorException if the program does not fit, a record lies outside its
+    // section, a name is not defined or an L record is malformed.
+    static LoadedProgram load(const ObjectProgram& program, Memory& memory, int loadAddress = -1);
+
+    // Same as load into an image of the program: image[0] is the byte at loadAddress,
+    // reserved areas are zeros
+    static LoadedProgram loadImage(const ObjectProgram& program, std::vector<uint8_t>& image, int loadAddress = -1);
+};
+
+#endif // LOADER_H
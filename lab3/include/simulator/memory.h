@@ -0,0 +1,114 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 24-bit address space of the target machine. Words are three bytes, most
+// significant first, as in T records; addresses wrap around at 2^24.
+//
+// The space is sparse: 4 KB pages are allocated on the first write to them and
+// untouched pages read as one shared zero page, so a program costs the pages it
+// uses. Pages are found through a directory of 64 tables of 64 pages each;
+// tables are allocated on demand as well.
+class Memory
+{
+public:
+    static const uint32_t SIZE = 1u << 24;
+    static const uint32_t ADDRESS_MASK = SIZE - 1;
+    static const uint32_t PAGE_SIZE = 4096;
+
+    Memory();
+
+    // The directory points into the tables of this instance
+    Memory(const Memory&) = delete;
+    Memory& operator=(const Memory&) = delete;
+
+    uint8_t read8(uint32_t address) const { return page(address)[address & OFFSET_MASK]; }
+
+    void write8(uint32_t address, uint8_t value) { writablePage(address)[address & OFFSET_MASK] = value; }
+
+    uint32_t read24(uint32_t address) const
+    {
+        uint32_t offset = address & OFFSET_MASK;
+        if (offset <= PAGE_SIZE - 3) {
+            const uint8_t* bytes = page(address) + offset;
+            return (static_cast<uint32_t>(bytes[0]) << 16) | (static_cast<uint32_t>(bytes[1]) << 8) | bytes[2];
+        }
+        return (static_cast<uint32_t>(read8(address)) << 16) | (static_cast<uint32_t>(read8(address + 1)) << 8) | read8(address + 2);
+    }
+
+    void write24(uint32_t address, uint32_t value)
+    {
+        uint32_t offset = address & OFFSET_MASK;
+        if (offset <= PAGE_SIZE - 3) {
+            uint8_t* bytes = writablePage(address) + offset;
+            bytes[0] = static_cast<uint8_t>(value >> 16);
+            bytes[1] = static_cast<uint8_t>(value >> 8);
+            bytes[2] = static_cast<uint8_t>(value);
+            return;
+        }
+        write8(address, static_cast<uint8_t>(value >> 16));
+        write8(address + 1, static_cast<uint8_t>(value >> 8));
+        write8(address + 2, static_cast<uint8_t>(value));
+    }
+
+    void writeBytes(uint32_t address, const uint8_t* data, size_t count); // Zeros allocate no pages
+
+    // Bytes [address, address + count) inside one allocated page, nullptr if they are not.
+    // Pages stay in place until clear, so the pointer may be kept until then.
+    uint8_t* findBytes(uint32_t address, size_t count)
+    {
+        uint8_t* bytes = directory_[(address >> 18) & (DIRECTORY_TABLES - 1)]->pages[(address >> 12) & (TABLE_PAGES - 1)];
+        if (bytes == zeroPage_ || (address & OFFSET_MASK) + count > PAGE_SIZE) {
+            return nullptr;
+        }
+        return bytes + (address & OFFSET_MASK);
+    }
+
+    // Releases all pages, so the whole space reads as zeros
+    void clear();
+
+    size_t getPageCount() const { return pages_.size(); } // Allocated pages
+    size_t getFootprint() const; // Bytes of pages and tables
+
+    // FNV-1a over the address and bytes of every page with a nonzero byte, in address order.
+    // Equal for equal contents, however the pages were allocated.
+    uint64_t digest() const;
+
+private:
+    static const uint32_t OFFSET_MASK = PAGE_SIZE - 1;
+    static const uint32_t TABLE_PAGES = 64;
+    static const uint32_t DIRECTORY_TABLES = SIZE / PAGE_SIZE / TABLE_PAGES;
+
+    struct Table
+    {
+        uint8_t* pages[TABLE_PAGES];
+    };
+
+    // Shared by all instances and never written
+    static uint8_t zeroPage_[PAGE_SIZE];
+    static Table zeroTable_;
+    static constexpr Table makeZeroTable(); // Constant initializer of zeroTable_
+
+    const uint8_t* page(uint32_t address) const
+    {
+        return directory_[(address >> 18) & (DIRECTORY_TABLES - 1)]->pages[(address >> 12) & (TABLE_PAGES - 1)];
+    }
+
+    uint8_t* writablePage(uint32_t address)
+    {
+        uint8_t* bytes = directory_[(address >> 18) & (DIRECTORY_TABLES - 1)]->pages[(address >> 12) & (TABLE_PAGES - 1)];
+        return bytes != zeroPage_ ? bytes : allocatePage(address);
+    }
+
+    uint8_t* allocatePage(uint32_t address);
+
+    Table* directory_[DIRECTORY_TABLES];
+    std::vector<std::unique_ptr<Table>> tables_;
+    std::vector<std::unique_ptr<uint8_t[]>> pages_;
+};
+
+#endif // MEMORY_H
@@ -0,0 +1,56 @@
+#ifndef OBJECTPROGRAM_H
+#define OBJECTPROGRAM_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Object records produced by the assembler (H, D, R, T, M, L, E), one control
+// section per H record. Addresses are relative to the section as written.
+class ObjectProgram
+{
+public:
+    struct Text
+    {
+        int address = 0;
+        int length = 0;             // Bytes; RESB and RESW records carry no data
+        std::vector<uint8_t> bytes; // Empty or exactly length bytes
+    };
+
+    struct Modification
+    {
+        int address = 0;
+        std::string symbol; // Empty, a label of the section or an R name
+    };
+
+    struct Definition
+    {
+        std::string name;
+        int address = 0;
+    };
+
+    struct Section
+    {
+        std::string name;
+        int startAddress = 0;
+        int length = 0;
+        int entryAddress = 0;
+        std::vector<Text> texts;
+        std::vector<Modification> modifications;
+        std::vector<Definition> definitions;
+        std::vector<std::string> references;
+        std::vector<uint8_t> lines; // Line program of the L records, see LineTable::encode
+    };
+
+    // Throws SimulatorException on a malformed record
+    static ObjectProgram parse(const std::vector<std::string>& records);
+    static ObjectProgram fromText(std::string_view text);
+
+    const std::vector<Section>& getSections() const { return sections_; }
+
+private:
+    std::vector<Section> sections_;
+};
+
+#endif // OBJECTPROGRAM_H
@@ -0,0 +1,42 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "assembler/commandtable.h"
+#include "simulator/loader.h"
+#include "simulator/simulator.h"
+#include "structures/linetable.h"
+
+// Profile of a run mapped back to the source: commands counted at the addresses
+// of a line are charged to it. Lines are found through the line table of the
+// first pass, with the sections placed as the loader placed them.
+class Profiler
+{
+public:
+    Profiler(const Simulator::Profile& profile, const LoadedProgram& program, const LineTable& lineTable);
+
+    uint64_t getTotal() const { return total_; }
+    uint64_t getUnmapped() const { return unmapped_; } // Counted at addresses no line covers
+    uint64_t getLineCount(size_t line) const { return line < lineCounts_.size() ? lineCounts_[line] : 0; } // By source line, from 1
+
+    // Every line of the source the table was built from, with its commands, their share
+    // and the address of the line
+    std::string annotatedListing(std::string_view source) const;
+
+    // Lines that ran, most commands first, then the counts by opcode
+    std::string flatProfile(std::string_view source, const CommandTable& commands) const;
+
+private:
+    static std::vector<std::string_view> splitLines(std::string_view source);
+
+    uint64_t total_;
+    uint64_t unmapped_;
+    std::vector<uint64_t> lineCounts_;
+    std::vector<int> lineAddresses_; // Loaded address of each source line in the table, -1 for others
+    std::vector<uint64_t> opcodeCounts_;
+};
+
+#endif // PROFILER_H
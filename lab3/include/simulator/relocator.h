@@ -0,0 +1,17 @@
+#ifndef RELOCATOR_H
+#define RELOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Adds a load delta to the 24-bit words of a program image named by M records.
+// Offsets are sorted, so the image is read and written front to back.
+class Relocator
+{
+public:
+    // Adds delta to the big-endian word at each offset of the image, modulo 2^24, in order,
+    // so words closer than 3 bytes see the sums before them. Every offset + 3 <= the image size.
+    static void apply(uint8_t* image, const uint32_t* offsets, size_t count, uint32_t delta);
+};
+
+#endif // RELOCATOR_H
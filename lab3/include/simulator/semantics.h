@@ -0,0 +1,53 @@
+#ifndef SEMANTICS_H
+#define SEMANTICS_H
+
+#include <cstdint>
+#include <string>
+#include "assembler/commandtable.h"
+
+// What a command does. Commands with a 3-byte operand use it as an address:
+// absolute (addressing type 0 or 1) or relative to the next command (type 2).
+enum class Operation : uint8_t
+{
+    NONE,          // No semantics: executing the command is a fault
+    NOP,
+    LOAD,          // R = [address]
+    STORE,         // [address] = R
+    ADD,           // 2 bytes: R1 += R2 of the operand byte; 4 bytes: R += [address]
+    SUB,           // As ADD
+    JUMP,
+    JUMP_ZERO,     // Jump if R == 0
+    JUMP_NOT_ZERO, // Jump if R != 0
+    INTERRUPT,     // Stops the simulator with the operand as the interrupt number
+    HALT
+};
+
+// Semantics of the commands of a table, keyed by command code
+class SemanticsTable
+{
+public:
+    static const int CODE_COUNT = 64; // The opcode byte is code * 4 + addressing type
+
+    struct Entry
+    {
+        Operation operation = Operation::NONE;
+        uint8_t registerNumber = 0; // 0 for R1
+        uint8_t length = 1;         // Command length in bytes
+    };
+
+    SemanticsTable();
+
+    // Semantics of the commands known by name: JMP, JZ, JNZ, ADD, SUB, INT, NOP,
+    // HALT, LOADRn and SAVERn (register n). Other commands have none.
+    explicit SemanticsTable(const CommandTable& commands);
+
+    // Throws SimulatorException if the code does not fit the opcode byte
+    void set(const Command& command, Operation operation, int registerNumber = 0);
+
+    const Entry& at(int code) const { return entries_[code]; }
+
+private:
+    Entry entries_[CODE_COUNT];
+};
+
+#endif // SEMANTICS_H
@@ -0,0 +1,234 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "simulator/codebuffer.h"
+#include "simulator/loader.h"
+#include "simulator/memory.h"
+#include "simulator/objectprogram.h"
+#include "simulator/semantics.h"
+
+// Interpreter of the target machine: 16 registers of 24 bits (R1..R16), an
+// instruction pointer and a 24-bit memory. Commands of the loaded program are
+// decoded once into a cache and dispatched through a table of handlers.
+//
+// Straight-line runs of commands ending with a jump, INT or HALT are translated
+// once into basic blocks: arrays of decoded commands that run back to back with
+// no fetch, limit check or instruction pointer update between them. Blocks are
+// cached by start address and dropped when a store writes into one of them.
+//
+// With the JIT on, blocks that run often are compiled to x86-64 code (see
+// jit.cpp). Compiled blocks jump straight to each other and check the limit
+// themselves; stores into code leave the native code, which is dropped along
+// with the blocks. Blocks the JIT cannot compile stay interpreted.
+
+// Native translation needs an x86-64 host and mmap
+#if defined(__x86_64__) && defined(__linux__)
+#define SIMULATOR_JIT 1
+#endif
+
+class Simulator
+{
+public:
+    static const int REGISTER_COUNT = 16;
+    static const size_t MAX_BLOCK_LENGTH = 64; // Commands per basic block
+    static const uint32_t JIT_THRESHOLD = 16;  // Runs of a block before it is compiled
+    static const size_t JIT_CODE_SIZE = 1 << 20; // Bytes of native code before all of it is dropped
+
+    enum StopReason { HALTED, INTERRUPTED, LIMIT_REACHED, FAULT };
+
+    explicit Simulator(const SemanticsTable& semantics);
+
+    // Clears the memory and registers, loads the program and sets the instruction
+    // pointer to its entry address. See Loader::load.
+    const LoadedProgram& load(const ObjectProgram& program, int loadAddress = -1);
+
+    // Executes at most maxInstructions commands. After an interrupt the
+    // instruction pointer is past the INT command, so run can be called again.
+    StopReason run(uint64_t maxInstructions);
+
+    uint32_t getRegister(int index) const { return registers_[index]; }
+    void setRegister(int index, uint32_t value) { registers_[index] = value & Memory::ADDRESS_MASK; }
+    uint32_t getInstructionPointer() const { return ip_; }
+    void setInstructionPointer(uint32_t ip) { ip_ = ip & Memory::ADDRESS_MASK; }
+
+    uint64_t getInstructionCount() const { return instructionCount_; } // Since the last load
+    uint32_t getInterruptNumber() const { return interruptNumber_; }
+    const LoadedProgram& getProgram() const { return program_; }
+
+    // Commands are cached for [begin, end); writes through getMemory() must be followed by invalidateCode
+    Memory& getMemory() { return memory_; }
+    const Memory& getMemory() const { return memory_; }
+    void setCodeRange(uint32_t begin, uint32_t end);
+    void invalidateCode();
+
+    // On by default; off, every command is fetched and dispatched on its own
+    void setBlockCacheEnabled(bool enabled);
+    bool isBlockCacheEnabled() const { return blockCacheEnabled_; }
+    size_t getBlockCount() const { return blockCount_; } // Blocks translated since the last flush
+
+    // Off by default and without effect where isJitAvailable is false or blocks are off
+    static bool isJitAvailable();
+    void setJitEnabled(bool enabled);
+    bool isJitEnabled() const { return jitEnabled_; }
+    size_t getCompiledBlockCount() const { return compiledCount_; } // Since the last flush
+
+    // Commands run at each address of the code range and with each opcode byte
+    struct Profile
+    {
+        uint32_t codeBegin = 0;
+        std::vector<uint64_t> addressCounts; // By offset in the code range
+        std::vector<uint64_t> opcodeCounts;  // 256 entries
+    };
+
+    // Off by default. Blocks count their runs, one increment per block, and the runs
+    // are spread over their commands when the blocks are flushed or the profile is read.
+    // Compiled blocks do not count, so no block is compiled while profiling is on.
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled() const { return profiling_; }
+    void resetProfile(); // Also done by load
+    Profile getProfile();
+
+private:
+    // Handlers of decoded commands; the order matches the dispatch tables of run and interpret
+    enum Handler : uint8_t
+    {
+        DECODE, ILLEGAL, NOP, LOAD, STORE, ADD_REGISTERS, ADD_MEMORY, SUB_REGISTERS, SUB_MEMORY,
+        JUMP, JUMP_ZERO, JUMP_NOT_ZERO, INTERRUPT, HALT,
+        // Only in blocks: the operand is bound to its bytes, or a store cannot reach code
+        LOAD_DIRECT, ADD_MEMORY_DIRECT, SUB_MEMORY_DIRECT, STORE_DIRECT, STORE_OUTSIDE,
+        BLOCK_END, // Not a command: continues at next
+        HANDLER_COUNT
+    };
+
+    struct Decoded
+    {
+        uint8_t handler = DECODE;
+        uint8_t length = 1;
+        uint8_t first = 0;    // Register of the command or the first register of the operand byte
+        uint8_t second = 0;   // Second register of the operand byte
+        uint8_t opcode = 0;
+        uint32_t operand = 0; // Resolved address or the operand byte
+        uint32_t next = 0;    // Address of the following command
+        uint8_t* bytes = nullptr; // Operand bytes of the *_DIRECT handlers
+    };
+
+    struct Block
+    {
+        uint32_t firstOp = 0; // Index in blockOps_; the commands are followed by a BLOCK_END
+        uint32_t count = 0;   // Commands, 0 if no block is translated at the address
+        uint32_t runs = 0;    // Counted up to JIT_THRESHOLD
+        int32_t native = NOT_COMPILED; // Offset of the native code in jitCode_
+    };
+
+    static const int32_t NOT_COMPILED = -1;
+    static const int32_t NOT_COMPILABLE = -2;
+
+    // Compiled block: runs commands while *budget allows, returns the next address.
+    // Bit 32 of the result is set when a store wrote into a block.
+    using NativeBlock = uint64_t (*)(uint32_t* registers, uint64_t* budget);
+
+    static bool endsBlock(uint8_t handler) { return handler >= JUMP && handler <= HALT; }
+
+    void decode(uint32_t address, Decoded& decoded) const;
+
+    // One command at a time through code_; run uses it without blocks and for single commands
+    StopReason interpret(uint64_t maxInstructions);
+    void bindOperand(Decoded& decoded); // Picks a block-only handler where one applies
+
+    // Decoded command at the address; outside the code range or with blocks on it is decoded every time
+    Decoded* fetch(uint32_t address)
+    {
+        uint32_t index = address - codeBegin_;
+        if (index < code_.size() && !blockCacheEnabled_) {
+            return &code_[index];
+        }
+        outside_.handler = DECODE;
+        return &outside_;
+    }
+
+    // Block starting at the code range offset, translated on first use; empty if no block can start there
+    Block blockAt(uint32_t index)
+    {
+        Block block = blockAt_[index];
+        return block.count != 0 ? block : translateBlock(index);
+    }
+
+    Block translateBlock(uint32_t index);
+    void flushBlocks();
+
+    // Compiles the block at the offset, sets its native field and returns it
+    Block compileBlock(uint32_t index);
+    void flushNative();
+
+    void countCommand(uint32_t address, uint8_t opcode, uint64_t times = 1)
+    {
+        opcodeCounts_[opcode] += times;
+        uint32_t index = address - codeBegin_;
+        if (index < addressCounts_.size()) addressCounts_[index] += times;
+    }
+
+    void foldBlockRuns(); // Adds the counted block runs to the command counts
+
+    // Whether the 3 bytes at the address overlap the code range
+    bool reachesCode(uint32_t address) const
+    {
+        int64_t index = static_cast<int64_t>(address) - codeBegin_;
+        return index > -3 && index < static_cast<int64_t>(code_.size());
+    }
+
+    // Returns whether a store wrote into a basic block. Without blocks it drops
+    // the cached commands instead: any that starts up to 3 bytes before the store.
+    bool invalidateStore(uint32_t address)
+    {
+        if (!reachesCode(address)) {
+            return false;
+        }
+        int64_t index = static_cast<int64_t>(address) - codeBegin_;
+        int64_t size = static_cast<int64_t>(code_.size());
+        if (blockCacheEnabled_) {
+            for (int64_t slot = std::max<int64_t>(index, 0); slot < std::min<int64_t>(index + 3, size); ++slot) {
+                if (blockCovered_[slot]) return true;
+            }
+            return false;
+        }
+        for (int64_t slot = std::max<int64_t>(index - 3, 0); slot < std::min<int64_t>(index + 3, size); ++slot) {
+            code_[slot].handler = DECODE;
+        }
+        return false;
+    }
+
+    SemanticsTable semantics_;
+    Memory memory_;
+    LoadedProgram program_;
+
+    uint32_t registers_[REGISTER_COUNT];
+    uint32_t ip_;
+    uint64_t instructionCount_;
+    uint32_t interruptNumber_;
+
+    uint32_t codeBegin_;
+    std::vector<Decoded> code_; // One entry per byte address of the code range, used without blocks
+    Decoded outside_;
+
+    bool blockCacheEnabled_;
+    bool blocksStale_;                   // interpret stored into a block; flushed when it returns
+    size_t blockCount_;
+    std::vector<Decoded> blockOps_;
+    std::vector<Block> blockAt_;         // Block starting at each byte of the code range
+    std::vector<uint8_t> blockCovered_;  // Byte belongs to a command of some block
+
+    bool jitEnabled_;
+    size_t compiledCount_;
+    std::unique_ptr<CodeBuffer> jitCode_; // Created when the JIT is first enabled
+
+    bool profiling_;
+    std::vector<uint64_t> addressCounts_;
+    uint64_t opcodeCounts_[256];
+    std::vector<uint64_t> blockRuns_; // Runs of the block whose commands start at the index in blockOps_
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,66 @@
+#ifndef CROSSREFERENCE_H
+#define CROSSREFERENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lines where each symbol of a symbol table is defined and used, built by the
+// first pass. Symbols are entry indexes of the table, lines are source line
+// numbers as in the line table (see Assembler::setLineNumbers).
+//
+// Sites are first added in line order with their symbols, then build sorts them
+// by symbol into one array: the sites of symbol s are sites_[offsets_[s]] up to
+// sites_[offsets_[s + 1]], still in line order. No symbol has a vector of its own.
+class CrossReference
+{
+public:
+    static const uint32_t NO_SYMBOL = UINT32_MAX;
+
+    struct Site
+    {
+        uint32_t value = 0; // Line << 1 | 1 for a definition
+
+        size_t line() const { return value >> 1; }
+        bool isDefinition() const { return (value & 1) != 0; }
+    };
+
+    // Run of sites of one symbol
+    class Sites
+    {
+    public:
+        Sites(const Site* begin, const Site* end) : begin_(begin), end_(end) {}
+
+        const Site* begin() const { return begin_; }
+        const Site* end() const { return end_; }
+        size_t size() const { return static_cast<size_t>(end_ - begin_); }
+        bool empty() const { return begin_ == end_; }
+
+    private:
+        const Site* begin_;
+        const Site* end_;
+    };
+
+    CrossReference();
+
+    void clear();
+
+    // Adds a site after those of earlier lines and returns its index for setSymbol.
+    // The symbol may be NO_SYMBOL until it is known; such sites are dropped by build.
+    size_t add(uint32_t symbol, size_t line, bool definition);
+    void setSymbol(size_t site, uint32_t symbol) { symbols_[site] = symbol; }
+
+    // Groups the added sites by symbol; symbolCount is the size of the symbol table
+    void build(size_t symbolCount);
+
+    // Sites of the symbol in line order, O(1); empty for symbols without any
+    Sites getSites(size_t symbol) const;
+    size_t size() const { return sites_.size(); }
+
+private:
+    std::vector<uint32_t> offsets_; // symbolCount + 1 entries after build
+    std::vector<Site> sites_;
+    std::vector<uint32_t> symbols_; // Symbol of each site until build
+};
+
+#endif // CROSSREFERENCE_H
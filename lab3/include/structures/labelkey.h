@@ -0,0 +1,70 @@
+#ifndef LABELKEY_H
+#define LABELKEY_H
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Upper-cased name padded with zeros to 16 bytes. Labels (up to 10 characters)
+// and mnemonics fit, so tables compare and hash them without touching the heap.
+class LabelKey
+{
+public:
+    static const size_t SIZE = 16;
+
+    LabelKey() { std::memset(bytes_, 0, SIZE); }
+
+    // The name must fit (see fits)
+    explicit LabelKey(std::string_view name)
+    {
+        std::memset(bytes_, 0, SIZE);
+        for (size_t i = 0; i < name.length(); ++i) {
+            bytes_[i] = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(name[i])));
+        }
+    }
+
+    // At most 16 bytes and no '\0', which would be taken for padding
+    static bool fits(std::string_view name)
+    {
+        return name.length() <= SIZE && std::memchr(name.data(), 0, name.length()) == nullptr;
+    }
+
+    bool operator==(const LabelKey& other) const
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes_));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.bytes_));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+#else
+        return std::memcmp(bytes_, other.bytes_, SIZE) == 0;
+#endif
+    }
+
+    bool operator!=(const LabelKey& other) const { return !(*this == other); }
+
+    size_t hash() const
+    {
+        uint64_t low;
+        uint64_t high;
+        std::memcpy(&low, bytes_, 8);
+        std::memcpy(&high, bytes_ + 8, 8);
+        uint64_t h = (low ^ (high * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    struct Hash
+    {
+        size_t operator()(const LabelKey& key) const { return key.hash(); }
+    };
+
+private:
+    alignas(16) unsigned char bytes_[SIZE];
+};
+
+#endif // LABELKEY_H
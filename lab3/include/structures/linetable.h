@@ -0,0 +1,50 @@
+#ifndef LINETABLE_H
+#define LINETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Address of every source line that emits a command or data, built by the
+// first pass. Lines are 1-based numbers of the source lines (see
+// Assembler::setLineNumbers), so a table read back from L records needs
+// only the source text; addresses are those of the section, as in the object records. Entries are
+// in program order, so within a section the addresses do not decrease.
+//
+// The entries of a section are stored in object code as a line program: for
+// every entry the line and address deltas from the previous one, starting from
+// line 0 and address 0. A line delta of 1-4 with an address delta of 0-31 takes
+// one byte, 0x00-0x7F; any other pair is 0x80 followed by two LEB128 varints.
+class LineTable
+{
+public:
+    struct Entry
+    {
+        uint32_t line = 0;
+        uint32_t section = 0; // Index in the section table
+        int32_t address = 0;
+    };
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    void clear() { entries_.clear(); }
+
+    void add(size_t line, size_t section, int address);
+    const Entry& operator[](size_t index) const { return entries_[index]; }
+    const std::vector<Entry>& getEntries() const { return entries_; }
+
+    // Index of the entry holding the address: the last one of the section at or before it, -1 if none
+    int find(size_t section, int address) const;
+
+    // Line program of the entries of the section, empty if it has none
+    std::vector<uint8_t> encode(size_t section) const;
+
+    // Appends the entries of a line program of the section, in one pass over it.
+    // Returns false and adds nothing if the program is malformed.
+    bool decode(size_t section, const uint8_t* data, size_t size);
+
+private:
+    std::vector<Entry> entries_;
+};
+
+#endif // LINETABLE_H
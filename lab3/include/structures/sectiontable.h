@@ -0,0 +1,44 @@
+#ifndef SECTIONTABLE_H
+#define SECTIONTABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "structures/section.h"
+
+// Sections in program order. Each one is placed right after the previous one,
+// so its offset in the program is the total length of the sections before it.
+class SectionTable
+{
+public:
+    SectionTable();
+
+    size_t size() const { return sections_.size(); }
+    bool empty() const { return sections_.empty(); }
+    void clear();
+
+    const Section& operator[](size_t index) const { return sections_[index]; }
+    const Section& back() const { return sections_.back(); }
+    const std::vector<Section>& getSections() const { return sections_; }
+
+    // Returns the index of the section; the name must not be in the table yet
+    size_t add(const Section& section);
+
+    // Section with this name (any case), -1 if there is none
+    int find(const std::string& name) const;
+
+    // Section whose [offset, offset + length) holds the program offset, -1 if none does
+    int findByOffset(int offset) const;
+
+    int getOffset(size_t index) const { return offsets_[index]; }
+    int getTotalLength() const { return offsets_.back(); }
+
+private:
+    static std::string upperCase(const std::string& name);
+
+    std::vector<Section> sections_;
+    std::vector<int> offsets_; // Running totals of the lengths, starts with 0
+    std::unordered_map<std::string, size_t> indexByName_; // Upper-case names
+};
+
+#endif // SECTIONTABLE_H
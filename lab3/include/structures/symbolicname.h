@@ -6,24 +6,33 @@
 class SymbolicName
 {
 public:
+    enum Kind { LOCAL, EXTDEF, EXTREF };
+
     SymbolicName();
-    SymbolicName(const std::string& name, int address, const std::string& section = "", const std::string& type = "");
+    SymbolicName(const std::string& name, int address, const std::string& section = "", Kind kind = LOCAL);
+    SymbolicName(const std::string& name, int address, const std::string& section, const std::string& type);
 
     const std::string& getName() const { return name_; }
     int getAddress() const { return address_; }
     const std::string& getSection() const { return section_; }
-    const std::string& getType() const { return type_; }
+    Kind getKind() const { return kind_; }
+    const std::string& getType() const { return typeName(kind_); }
 
     void setName(const std::string& name) { name_ = name; }
     void setAddress(int address) { address_ = address; }
     void setSection(const std::string& section) { section_ = section; }
-    void setType(const std::string& type) { type_ = type; }
+    void setKind(Kind kind) { kind_ = kind; }
+    void setType(const std::string& type) { kind_ = kindFromType(type); }
+
+    // "ВИ" (external definition), "ВС" (external reference) or "" (normal), as the TSI shows the kind
+    static const std::string& typeName(Kind kind);
+    static Kind kindFromType(const std::string& type);
     
 private:
     std::string name_;
     int address_;
     std::string section_;
-    std::string type_;  // "ВИ" (external definition), "ВС" (external reference), or "" (normal)
+    Kind kind_;
 };
 
 #endif // SYMBOLICNAME_H
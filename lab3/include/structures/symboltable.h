@@ -0,0 +1,51 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "structures/symbolicname.h"
+
+// TSI stored by columns: names in one pool, 4-byte addresses, section indexes
+// (into the assembler's SectionTable), 1-byte kinds and name hashes. Entries
+// keep the order they were added in.
+class SymbolTable
+{
+public:
+    SymbolTable();
+
+    size_t size() const { return addresses_.size(); }
+    bool empty() const { return addresses_.empty(); }
+    void clear();
+
+    // Stores the name upper-cased and returns the index of the entry
+    size_t add(std::string_view name, int address, size_t section, SymbolicName::Kind kind);
+
+    // Entry with this name (any case) in the section, -1 if there is none
+    int find(std::string_view name, size_t section) const;
+
+    std::string_view getName(size_t index) const;
+    int getAddress(size_t index) const { return addresses_[index]; }
+    size_t getSection(size_t index) const { return sections_[index]; }
+    SymbolicName::Kind getKind(size_t index) const { return static_cast<SymbolicName::Kind>(kinds_[index]); }
+
+    void setAddress(size_t index, int address) { addresses_[index] = address; }
+
+private:
+    static uint32_t hash(std::string_view name, size_t section); // Of the upper-cased name
+    bool matches(size_t index, std::string_view name) const;     // Name equal up to case
+    void insertSlot(uint32_t index);
+    void grow();
+
+    std::string namePool_;
+    std::vector<uint32_t> nameOffsets_; // Start of every name in namePool_, then the end of the pool
+    std::vector<int32_t> addresses_;
+    std::vector<uint32_t> sections_;
+    std::vector<uint8_t> kinds_;
+    std::vector<uint32_t> hashes_;
+
+    std::vector<int32_t> slots_; // Open addressing: entry index or -1, size is a power of two
+};
+
+#endif // SYMBOLTABLE_H
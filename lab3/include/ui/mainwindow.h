@@ -43,6 +43,9 @@ private:
     
     // Assembler instance
     Assembler assembler;
+
+    // Line numbers of the source of the last first pass, for the listing of the second pass
+    std::vector<size_t> firstPassLineNumbers;
     
     // Sample source codes for different addressing modes
     const QString straightSample = 
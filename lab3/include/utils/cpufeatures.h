@@ -0,0 +1,8 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+// Instruction set extensions checked at run time by the SIMD kernels.
+// SSE2 is part of x86-64 and needs no check.
+bool cpuHasAvx2();
+
+#endif // CPUFEATURES_H
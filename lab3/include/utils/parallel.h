@@ -0,0 +1,16 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Number of threads parallelFor uses, at least 1
+size_t workerCount();
+
+// Calls body(0) ... body(count - 1) on up to workerCount() threads, the calling
+// thread included. Indices are handed out one at a time, so tasks of different
+// size are balanced. The first exception thrown by body is rethrown after all
+// threads finish.
+void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+#endif // PARALLEL_H
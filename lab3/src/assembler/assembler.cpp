@@ -1,50 +1,67 @@
 #include "assembler/assembler.h"
+#include "assembler/literalcodec.h"
+#include "utils/parallel.h"
 #include <algorithm>
-#include <regex>
 #include <sstream>
 #include <iomanip>
 #include <cctype>
-#include <set>
 
-const std::vector<std::string> Assembler::AVAILABLE_DIRECTIVES = {
-    "START", "END", "WORD", "BYTE", "RESB", "RESW", "EXTDEF", "EXTREF", "CSECT"
-};
+namespace {
+
+// Upper-case hex padded with zeros, as std::hex << std::setw(width) prints it
+std::string toHex(int value, int width)
+{
+    static const char digits[] = "0123456789ABCDEF";
+
+    char buffer[8];
+    int count = 0;
+    unsigned int rest = static_cast<unsigned int>(value);
+    do {
+        buffer[count++] = digits[rest & 0xF];
+        rest >>= 4;
+    } while (rest != 0);
+
+    std::string result(count < width ? width - count : 0, '0');
+    while (count > 0) {
+        result += buffer[--count];
+    }
+    return result;
+}
+
+// M record of a modification table line; the label is empty for addresses within the section
+std::string modificationRecord(const TNLine& line)
+{
+    return "M " + line.getAddress() + "\t" + line.getLabel();
+}
+
+} // namespace
 
 Assembler::Assembler()
-    : ip_(0), secondIp_(0)
+    : sectionIndex_(0), lineRecords_(false), listing_(nullptr), ip_(0), secondIp_(0)
 {
     // Initialize with default commands
-    availableCommands_ = {
+    setCommandTable(std::make_shared<const CommandTable>(std::vector<Command>{
         Command("JMP", 1, 4),
         Command("LOADR1", 2, 4),
         Command("LOADR2", 3, 4),
         Command("ADD", 4, 2),
         Command("SAVER1", 5, 4),
         Command("INT", 6, 2)
-    };
+    }));
 }
 
 void Assembler::setAvailableCommands(const std::vector<Command>& commands)
 {
-    // Check name uniqueness
-    std::set<std::string> names;
-    for (const auto& cmd : commands) {
-        std::string upperName = cmd.getName();
-        std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
-        if (!names.insert(upperName).second) {
-            throw AssemblerException("Все имена команд должны быть уникальными");
-        }
-    }
+    // The table checks name and code uniqueness
+    setCommandTable(std::make_shared<const CommandTable>(commands));
+}
 
-    // Check code uniqueness
-    std::set<int> codes;
-    for (const auto& cmd : commands) {
-        if (!codes.insert(cmd.getCode()).second) {
-            throw AssemblerException("Все коды команд должны быть уникальными");
-        }
-    }
+void Assembler::setCommandTable(std::shared_ptr<const CommandTable> commandTable)
+{
+    commandTable_ = std::move(commandTable);
 
-    availableCommands_ = commands;
+    // Whether a name is a label depends on the commands
+    tokens_ = TokenClassifier(commandTable_);
 }
 
 void Assembler::clearTSI()
@@ -70,190 +87,217 @@ void Assembler::pushToTN(const std::string& address, const std::string& label, c
 void Assembler::addSection(const Section& section)
 {
     // Check if section name is unique
-    for (const auto& s : sections_) {
-        std::string upperSectionName = s.getName();
-        std::string upperNewName = section.getName();
-        std::transform(upperSectionName.begin(), upperSectionName.end(), upperSectionName.begin(), ::toupper);
-        std::transform(upperNewName.begin(), upperNewName.end(), upperNewName.begin(), ::toupper);
-        
-        if (upperSectionName == upperNewName) {
-            throw AssemblerException("Все имена секций должны быть уникальными: " + section.getName());
-        }
+    if (sections_.find(section.getName()) != -1) {
+        throw AssemblerException("Все имена секций должны быть уникальными: " + section.getName());
     }
     
     // Check if total length would overflow
-    int totalLength = section.getLength();
-    for (const auto& s : sections_) {
-        totalLength += s.getLength();
-    }
-    overflowCheck(totalLength, section.getName());
+    overflowCheck(sections_.getTotalLength() + section.getLength(), section.getName());
     
-    sections_.push_back(section);
+    sections_.add(section);
 }
 
 void Assembler::tsiCheck()
 {
-    for (const auto& sym : tsi_) {
-        if (sym.getType() == "ВИ" && sym.getAddress() == -1) {
+    for (size_t i = 0; i < tsi_.size(); ++i) {
+        if (tsi_.getKind(i) == SymbolicName::EXTDEF && tsi_.getAddress(i) == -1) {
             throw AssemblerException("Не всем внешним именам было присвоено значение");
         }
     }
 }
 
-void Assembler::orderCheck(const std::string& directive, const std::string& previousCommand, const std::string& textLine)
+void Assembler::orderCheck(Directive directive, Directive previousDirective, const std::string& textLine)
 {
-    std::string upperDirective = directive;
-    std::string upperPrevious = previousCommand;
-    std::transform(upperDirective.begin(), upperDirective.end(), upperDirective.begin(), ::toupper);
-    std::transform(upperPrevious.begin(), upperPrevious.end(), upperPrevious.begin(), ::toupper);
-    
-    if (upperDirective == "EXTDEF") {
-        if (upperPrevious != "START" && upperPrevious != "CSECT" && upperPrevious != "EXTDEF") {
+    bool afterHeader = previousDirective == Directive::START || previousDirective == Directive::CSECT
+        || previousDirective == Directive::EXTDEF;
+
+    if (directive == Directive::EXTDEF) {
+        if (!afterHeader) {
             throw AssemblerException("Директива EXTDEF может стоять только после директив START, CSECT и EXTDEF: " + textLine);
         }
-    } else if (upperDirective == "EXTREF") {
-        if (upperPrevious != "START" && upperPrevious != "CSECT" && upperPrevious != "EXTDEF" && upperPrevious != "EXTREF") {
+    } else if (directive == Directive::EXTREF) {
+        if (!afterHeader && previousDirective != Directive::EXTREF) {
             throw AssemblerException("Директива EXTREF может стоять только после директив START, CSECT, EXTDEF и EXTREF: " + textLine);
         }
     }
 }
 
-bool Assembler::isCommand(const std::string& name) const
+void Assembler::addToLineTable(const TranslatedLine& line, size_t lineIndex, size_t section)
 {
-    if (name.empty()) return false;
-
-    std::string upperName = name;
-    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
-
-    return std::any_of(availableCommands_.begin(), availableCommands_.end(),
-                       [&upperName](const Command& cmd) {
-                           std::string cmdName = cmd.getName();
-                           std::transform(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
-                           return cmdName == upperName;
-                       });
+    // Only lines that take up addresses
+    switch (line.kind) {
+    case TranslatedLine::WORD_LINE:
+    case TranslatedLine::BYTE_LINE:
+    case TranslatedLine::RESB_LINE:
+    case TranslatedLine::RESW_LINE:
+    case TranslatedLine::COMMAND_LINE:
+        lineTable_.add(sourceLineNumber(lineIndex), section, line.address);
+        break;
+    default:
+        break;
+    }
 }
 
-bool Assembler::isDirective(const std::string& name) const
+void Assembler::addToCrossReference(const TranslatedLine& line, size_t lineIndex, size_t section,
+                                                 std::vector<ForwardSite>& forwardSites)
 {
-    if (name.empty()) return false;
+    const CodeLine& codeLine = line.codeLine;
+
+    switch (line.kind) {
+    case TranslatedLine::START_LINE:
+    case TranslatedLine::CSECT_LINE:
+        return; // Section names are not symbols
+    case TranslatedLine::EXTDEF_LINE:
+        addSite(codeLine.getFirstOperand(), lineIndex, false, section, forwardSites);
+        return;
+    case TranslatedLine::EXTREF_LINE:
+        addSite(codeLine.getFirstOperand(), lineIndex, true, section, forwardSites);
+        return;
+    default:
+        break;
+    }
 
-    std::string upperName = name;
-    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+    if (codeLine.hasLabel()) {
+        addSite(codeLine.getLabel(), lineIndex, true, section, forwardSites);
+    }
+    if (line.operandKind == TranslatedLine::LABEL) {
+        addSite(codeLine.getFirstOperand(), lineIndex, false, section, forwardSites);
+    } else if (line.operandKind == TranslatedLine::RELATIVE_LABEL) {
+        const std::string& operand = codeLine.getFirstOperand();
+        addSite(operand.substr(1, operand.length() - 2), lineIndex, false, section, forwardSites);
+    }
+}
 
-    return std::find(AVAILABLE_DIRECTIVES.begin(), AVAILABLE_DIRECTIVES.end(), upperName) != AVAILABLE_DIRECTIVES.end();
+void Assembler::addSite(const std::string& name, size_t lineIndex, bool definition, size_t section,
+                                     std::vector<ForwardSite>& forwardSites)
+{
+    int symbol = tsi_.find(name, section);
+    size_t site = crossReference_.add(symbol != -1 ? static_cast<uint32_t>(symbol) : CrossReference::NO_SYMBOL,
+                                      sourceLineNumber(lineIndex), definition);
+    if (symbol == -1) {
+        forwardSites.push_back({ site, section, name });
+    }
 }
 
-bool Assembler::isLabel(const std::string& name) const
+void Assembler::buildCrossReference(const std::vector<ForwardSite>& forwardSites)
 {
-    if (isRegister(name)) {
-        return false; // Регистр не может быть меткой
+    for (const auto& forward : forwardSites) {
+        if (forward.section < sections_.size()) {
+            int symbol = tsi_.find(forward.name, forward.section);
+            if (symbol != -1) {
+                crossReference_.setSymbol(forward.site, static_cast<uint32_t>(symbol));
+            }
+        }
     }
-    if (name.empty() || name.length() > 10) return false;
+    crossReference_.build(tsi_.size());
+}
 
-    // Must start with a letter
-    if (!std::isalpha(name[0])) return false;
+void Assembler::pushLineRecord(size_t section, std::vector<std::string>& records) const
+{
+    static const char digits[] = "0123456789ABCDEF";
 
-    // Must contain only alphanumeric characters and underscore
-    for (char c : name) {
-        if (!std::isalnum(c) && c != '_') return false;
+    if (!lineRecords_) {
+        return;
+    }
+    std::vector<uint8_t> program = lineTable_.encode(section);
+    if (program.empty()) {
+        return;
     }
 
-    // Must not be a register
-    if (isRegister(name)) return false;
+    std::string record = "L ";
+    record.reserve(record.size() + program.size() * 2);
+    for (uint8_t byte : program) {
+        record += digits[byte >> 4];
+        record += digits[byte & 0xF];
+    }
+    records.push_back(std::move(record));
+}
+
+bool Assembler::isCommand(const std::string& name) const
+{
+    return tokens_.classify(name).command != nullptr;
+}
 
-    // Must not be a command or directive
-    if (isCommand(name) || isDirective(name)) return false;
+bool Assembler::isDirective(const std::string& name) const
+{
+    return tokens_.classify(name).directive != Directive::NONE;
+}
 
-    return true;
+bool Assembler::isLabel(const std::string& name) const
+{
+    return tokens_.classify(name).label;
 }
 
 bool Assembler::isRegister(const std::string& name) const
 {
-    if (name.empty()) return false;
-
-    std::regex regPattern(R"(^R(?:[1-9]|1[0-6])$)");
-    return std::regex_match(name, regPattern);
+    return tokens_.classify(name).registerNumber != 0;
 }
 
 bool Assembler::isRelativeLabel(const std::string& str) const
 {
-    if (str.empty() || str.length() < 3) return false;
-
-    // Must start with [ and end with ]
-    if (str.front() != '[' || str.back() != ']') return false;
-
-    // Extract the label inside brackets
-    std::string labelInside = str.substr(1, str.length() - 2);
-
-    // Check if it's a valid label
-    return isLabel(labelInside);
+    return tokens_.classify(str).relativeLabel;
 }
 
 bool Assembler::isCString(const std::string& str) const
 {
-    if (str.length() < 4) return false;
-
-    // Must start with C" and end with "
-    if (str[0] != 'C' || str[1] != '"' || str.back() != '"') return false;
-
-    // Check if all characters are printable ASCII
-    std::string content = str.substr(2, str.length() - 3);
-    for (char c : content) {
-        if (c < 32 || c > 126) return false; // Printable ASCII range
-    }
-
-    return true;
+    return tokens_.classify(str).cString;
 }
 
 bool Assembler::isXString(const std::string& str) const
 {
-    if (str.length() < 4) return false;
-
-    // Must start with X" and end with "
-    if (str[0] != 'X' || str[1] != '"' || str.back() != '"') return false;
-
-    // Check if all characters are valid hex digits
-    std::string content = str.substr(2, str.length() - 3);
-    if (content.empty() || content.length() % 2 != 0) return false;
-
-    for (char c : content) {
-        if (!std::isxdigit(c)) return false;
-    }
-
-    return true;
+    return tokens_.classify(str).xString;
 }
 
 int Assembler::getRegisterNumber(const std::string& reg) const
 {
-    if (!isRegister(reg)) {
+    int number = tokens_.classify(reg).registerNumber;
+    if (number == 0) {
         throw AssemblerException("Invalid register: " + reg);
     }
 
-    return std::stoi(reg.substr(1));
+    return number;
+}
+
+std::vector<SymbolicName> Assembler::getTSI() const
+{
+    std::vector<SymbolicName> result;
+    result.reserve(tsi_.size());
+    for (size_t i = 0; i < tsi_.size(); ++i) {
+        result.push_back(symbolicName(i));
+    }
+    return result;
 }
 
-SymbolicName* Assembler::getSymbolicName(const std::string& name, const std::string& section)
+std::optional<SymbolicName> Assembler::getSymbolicName(const std::string& name, const std::string& section) const
 {
-    std::string upperName = name;
-    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+    // The current section is in sections_ only once it is closed
+    int sectionIndex = sections_.find(section);
+    if (sectionIndex == -1) {
+        if (section != currentSection_.getName()) {
+            return std::nullopt;
+        }
+        sectionIndex = static_cast<int>(sectionIndex_);
+    }
 
-    auto it = std::find_if(tsi_.begin(), tsi_.end(),
-                           [&upperName, &section](const SymbolicName& sym) {
-                               std::string symName = sym.getName();
-                               std::transform(symName.begin(), symName.end(), symName.begin(), ::toupper);
-                               return symName == upperName && sym.getSection() == section;
-                           });
+    int index = tsi_.find(name, static_cast<size_t>(sectionIndex));
+    if (index == -1) {
+        return std::nullopt;
+    }
+    return symbolicName(index);
+}
 
-    return (it != tsi_.end()) ? &(*it) : nullptr;
+SymbolicName Assembler::symbolicName(size_t index) const
+{
+    size_t section = tsi_.getSection(index);
+    const std::string& sectionName = section < sections_.size() ? sections_[section].getName() : currentSection_.getName();
+    return SymbolicName(std::string(tsi_.getName(index)), tsi_.getAddress(index), sectionName, tsi_.getKind(index));
 }
 
 std::string Assembler::convertToASCII(const std::string& str) const
 {
-    std::stringstream result;
-    for (char c : str) {
-        result << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << (int)(unsigned char)c;
-    }
-    return result.str();
+    std::string result;
+    LiteralCodec::encodeHex(str.data(), str.length(), result);
+    return result;
 }
 
 void Assembler::overflowCheck(int value, const std::string& textLine) const
@@ -263,282 +307,601 @@ void Assembler::overflowCheck(int value, const std::string& textLine) const
     }
 }
 
-void Assembler::pushToTSI(const std::string& name, int address, const std::string& section, const std::string& type, const std::string& textLine)
+void Assembler::pushToTSI(const std::string& name, int address, size_t section, SymbolicName::Kind kind, const std::string& textLine)
 {
-    std::string upperName = name;
-    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
-    
-    // Check if symbol already exists in the same section
-    for (auto& sym : tsi_) {
-        std::string upperSymName = sym.getName();
-        std::transform(upperSymName.begin(), upperSymName.end(), upperSymName.begin(), ::toupper);
-        
-        if (sym.getSection() == section && upperSymName == upperName) {
-            // If it's an external definition (ВИ) and we're trying to set its address
-            if (sym.getType() == "ВИ") {
-                if (type == "ВИ" || type == "ВС") {
-                    throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
+    // A name is defined once per section
+    int existing = tsi_.find(name, section);
+    if (existing != -1) {
+        // If it's an external definition (ВИ) and we're trying to set its address
+        if (tsi_.getKind(existing) == SymbolicName::EXTDEF) {
+            if (kind != SymbolicName::LOCAL) {
+                throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
+            } else {
+                // Setting address for EXTDEF
+                if (tsi_.getAddress(existing) == -1 && address != -1) {
+                    tsi_.setAddress(existing, address);
+                    return;
                 } else {
-                    // Setting address for EXTDEF
-                    if (sym.getAddress() == -1 && address != -1) {
-                        sym.setAddress(address);
-                        return;
-                    } else {
-                        throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
-                    }
+                    throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
                 }
-            } else {
-                throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
             }
+        } else {
+            throw AssemblerException("Такая метка уже есть в ТСИ: " + textLine);
         }
     }
-    
-    tsi_.emplace_back(upperName, address, section, type);
+
+    tsi_.add(name, address, section, kind);
 }
 
 std::vector<std::string> Assembler::firstPass(const std::vector<std::vector<std::string>>& lines, const std::string& addressingMode)
 {
+    return firstPass(lines, addressingModeFromName(addressingMode));
+}
+
+std::vector<std::string> Assembler::firstPass(const std::vector<std::vector<std::string>>& lines, AddressingMode addressingMode)
+{
+    lineTable_.clear();
+    crossReference_.clear();
+    tokens_.clear();
+
+    std::vector<size_t> bounds = findSectionBounds(lines);
+    if (!bounds.empty()) {
+        std::vector<std::string> firstPassCode;
+        if (parallelFirstPass(lines, bounds, addressingMode, firstPassCode)) {
+            return firstPassCode;
+        }
+
+        // Errors and conflicts between chunks are reported by the serial pass
+        clearTSI();
+        clearSections();
+        lineTable_.clear();
+        crossReference_.clear();
+    }
+
     std::vector<std::string> firstPassCode;
-    std::string previousCommand = "";
+    std::vector<ForwardSite> forwardSites;
+    FirstPassState state;
 
     ip_ = 0;
+    sectionIndex_ = 0;
 
-    bool startFlag = false;
-    bool endFlag = false;
-    bool firstMeaningfulLine = true;
-    for (const auto& line : lines) {
-        std::string textLine;
-        for (const auto& token : line) {
-            textLine += token + " ";
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (state.endFlag) break;
+
+        TranslatedLine translated = translateLine(lines[i], addressingMode, state);
+        addToLineTable(translated, i, sections_.size());
+        addToCrossReference(translated, i, sections_.size(), forwardSites);
+        if (translated.kind == TranslatedLine::END_LINE) {
+            continue; // END directive doesn't produce output in first pass
+        }
+
+        firstPassCode.push_back(formatFirstPassLine(translated));
+    }
+
+    if (!state.endFlag) {
+        throw AssemblerException("Не найдена точка входа в программу.");
+    }
+
+    buildCrossReference(forwardSites);
+    
+    tsiCheck();
+
+    return firstPassCode;
+}
+
+std::vector<size_t> Assembler::findSectionBounds(const std::vector<std::vector<std::string>>& lines) const
+{
+    // Chunks are independent only in a fresh assembler: symbols and sections
+    // left from a previous pass take part in the uniqueness checks
+    if (lines.size() < PARALLEL_MIN_LINES || workerCount() < 2 || !tsi_.empty() || !sections_.empty()) {
+        return {};
+    }
+
+    // Line indexes where sections start, then the index after the last line
+    // the serial pass would read (END or the end of the source)
+    std::vector<size_t> bounds{ 0 };
+    std::vector<std::string> names;
+    size_t end = lines.size();
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        CodeLine codeLine;
+        try {
+            codeLine = Parser::parseCodeLine(lines[i]);
+        } catch (const AssemblerException&) {
+            break; // The chunk with this line fails
         }
 
-        std::string firstPassLine;
+        Directive directive = directiveFromName(codeLine.getCommand());
+
+        if (i == 0 || directive == Directive::CSECT) {
+            std::string upperName = codeLine.getLabel();
+            std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+
+            // Sections with the same name are an error the serial pass reports
+            if (std::find(names.begin(), names.end(), upperName) != names.end()) {
+                return {};
+            }
+            names.push_back(upperName);
 
-        if (!startFlag && ip_ != 0) {
-            throw AssemblerException("Не найдена директива START в начале программы");
+            if (i != 0) {
+                bounds.push_back(i);
+            }
+        } else if (directive == Directive::END) {
+            end = i + 1;
+            break;
         }
+    }
+
+    bounds.push_back(end);
+    return bounds;
+}
 
-        if (startFlag) {
-            overflowCheck(ip_, textLine);
+bool Assembler::parallelFirstPass(const std::vector<std::vector<std::string>>& lines, const std::vector<size_t>& bounds,
+                                               AddressingMode addressingMode, std::vector<std::string>& firstPassCode)
+{
+    size_t sectionCount = bounds.size() - 1;
+    std::vector<std::string> sectionNames(sectionCount);
+    std::vector<FirstPassChunk> chunks;
+
+    for (size_t section = 0; section < sectionCount; ++section) {
+        try {
+            sectionNames[section] = Parser::parseCodeLine(lines[bounds[section]]).getLabel();
+        } catch (const AssemblerException&) {
+            return false;
         }
 
-        if (endFlag) break;
+        for (size_t begin = bounds[section]; begin < bounds[section + 1]; begin += PARALLEL_CHUNK_LINES) {
+            FirstPassChunk chunk;
+            chunk.section = section;
+            chunk.begin = begin;
+            chunk.end = std::min(begin + PARALLEL_CHUNK_LINES, bounds[section + 1]);
+            chunk.startsSection = begin == bounds[section];
+            chunks.push_back(std::move(chunk));
+        }
+    }
 
-        CodeLine codeLine = getCodeLineFromSource(line);
-        
-        if (codeLine.getCommand().empty()) {
-            throw AssemblerException("Пустая команда в строке: " + textLine);
+    size_t shardCount = workerCount();
+    parallelFor(chunks.size(), [&](size_t i) {
+        firstPassChunk(lines, sectionNames[chunks[i].section], addressingMode, shardCount, chunks[i]);
+    });
+
+    // Prefix sum of chunk lengths: a chunk continuing a section starts where the previous one ended.
+    // Chunks check overflow with addresses from zero, so the real end is checked here.
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        FirstPassChunk& chunk = chunks[i];
+        if (chunk.failed) {
+            return false;
         }
-        
-        std::string upperCmd = codeLine.getCommand();
-        std::transform(upperCmd.begin(), upperCmd.end(), upperCmd.begin(), ::toupper);
-        
-        if (firstMeaningfulLine) {
-            if (upperCmd != "START") {
-                throw AssemblerException(
-                    "Первая строка программы должна быть 'PROG START 0', "
-                    "а не '" + upperCmd + "'. Строка: " + textLine
-                    );
+
+        if (!chunk.startsSection) {
+            chunk.offset = chunks[i - 1].ip;
+            chunk.ip += chunk.offset;
+            if (chunk.ip > MAX_ADDRESS) {
+                return false;
             }
-            firstMeaningfulLine = false;
         }
+    }
 
-        // Debug: Check what we're processing
-        bool isDir = isDirective(upperCmd);
-        bool isCmd = isCommand(upperCmd);
-        
-        if (!isDir && !isCmd) {
-            std::string debugInfo = "Команда: '" + upperCmd + "', Оригинал: '" + codeLine.getCommand() + 
-                                   "', isDirective: " + (isDir ? "true" : "false") + 
-                                   ", isCommand: " + (isCmd ? "true" : "false");
-            throw AssemblerException("Неизвестная команда или директива. " + debugInfo + ". Строка: " + textLine);
-        }
+    if (!chunks.back().endFlag) {
+        return false;
+    }
 
-        // Process command part (use upperCmd for consistency)
-        if (isDirective(upperCmd)) {
-            if (upperCmd == "START") {
-                firstPassLine = processStartDirective(codeLine, textLine, startFlag);
-            } else if (upperCmd == "CSECT") {
-                firstPassLine = processCsectDirective(codeLine, textLine);
-            } else if (upperCmd == "EXTDEF") {
-                firstPassLine = processExtdefDirective(codeLine, textLine, previousCommand);
-            } else if (upperCmd == "EXTREF") {
-                firstPassLine = processExtrefDirective(codeLine, textLine, previousCommand);
-            } else if (upperCmd == "WORD") {
-                if (codeLine.hasLabel()) {
-                    pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-                }
-                firstPassLine = processWordDirective(codeLine, textLine);
-            } else if (upperCmd == "BYTE") {
-                if (codeLine.hasLabel()) {
-                    pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-                }
-                firstPassLine = processByteDirective(codeLine, textLine);
-            } else if (upperCmd == "RESW") {
-                if (codeLine.hasLabel()) {
-                    pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-                }
-                firstPassLine = processReswDirective(codeLine, textLine);
-            } else if (upperCmd == "RESB") {
-                if (codeLine.hasLabel()) {
-                    pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-                }
-                firstPassLine = processResbDirective(codeLine, textLine);
-            } else if (upperCmd == "END") {
-                if (!startFlag || endFlag) {
-                    throw AssemblerException("Не найдена метка START либо ошибка в директивах START/END: " + textLine);
-                }
-                
-                if (codeLine.hasLabel()) {
-                    pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-                }
-                
-                processEndDirective(codeLine, textLine);
-                endFlag = true;
+    // Sections are closed in source order with the checks of CSECT and END
+    Section section;
+    try {
+        size_t first = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (i + 1 < chunks.size() && !chunks[i + 1].startsSection) {
                 continue;
             }
-        } else if (isCommand(upperCmd)) {
-            if (codeLine.hasLabel()) {
-                pushToTSI(codeLine.getLabel(), ip_, currentSection_.getName(), "", textLine);
-            }
-            // Find the command
-            auto cmdIt = std::find_if(availableCommands_.begin(), availableCommands_.end(),
-                                      [&codeLine](const Command& cmd) {
-                                          std::string cmdName = cmd.getName();
-                                          std::transform(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
-                                          std::string lineCmd = codeLine.getCommand();
-                                          std::transform(lineCmd.begin(), lineCmd.end(), lineCmd.begin(), ::toupper);
-                                          return cmdName == lineCmd;
-                                      });
-
-            if (cmdIt == availableCommands_.end()) {
-                throw AssemblerException("Неизвестная команда: " + textLine);
+
+            section = chunks[first].currentSection;
+            if (i + 1 < chunks.size()) {
+                section.setEndAddress(chunks[i + 1].lines.front().value);
+            } else {
+                const TranslatedLine& endLine = chunks[i].lines.back();
+                section.setEndAddress(endLine.codeLine.hasFirstOperand() ? endLine.value : section.getStartAddress());
             }
+            section.setLength(chunks[i].ip - section.getStartAddress());
+            addSection(section);
 
-            const Command& command = *cmdIt;
+            first = i + 1;
+        }
+    } catch (const AssemblerException&) {
+        return false;
+    }
 
-            switch (command.getLength()) {
-            case 1: {
-                if (codeLine.hasFirstOperand()) {
-                    throw AssemblerException("Ожидается ноль операндов: " + textLine);
-                }
-                overflowCheck(ip_ + 1, textLine);
-                std::stringstream ss;
-                ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                   << " " << std::setw(2) << (command.getCode() * 4 + 0);
-                firstPassLine = ss.str();
-                ip_ += 1;
-                break;
+    // Symbols are merged in shards by name hash; a name always falls into the same shard
+    std::vector<char> conflicts(shardCount, 0);
+    parallelFor(shardCount, [&](size_t shard) {
+        conflicts[shard] = !mergeChunkSymbols(chunks, shard, sectionCount);
+    });
+    if (std::find(conflicts.begin(), conflicts.end(), 1) != conflicts.end()) {
+        return false;
+    }
+
+    parallelFor(chunks.size(), [&](size_t i) {
+        FirstPassChunk& chunk = chunks[i];
+        for (auto& line : chunk.lines) {
+            if (line.kind != TranslatedLine::END_LINE) {
+                line.address += chunk.offset;
+                chunk.firstPassCode.push_back(formatFirstPassLine(line));
             }
-            case 2:
-                if (!codeLine.hasFirstOperand()) {
-                    throw AssemblerException("Ожидается минимум один операнд, но было получено ноль: " + textLine);
-                }
+        }
+    });
 
-                if (codeLine.hasSecondOperand()) {
-                    // Two registers
-                    if (isRegister(codeLine.getFirstOperand()) && isRegister(codeLine.getSecondOperand())) {
-                        overflowCheck(ip_ + 2, textLine);
-                        std::stringstream ss;
-                        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                           << " " << std::setw(2) << (command.getCode() * 4 + 0)
-                           << " " << codeLine.getFirstOperand() << " " << codeLine.getSecondOperand();
-                        firstPassLine = ss.str();
-                        ip_ += 2;
-                    } else {
-                        throw AssemblerException("Неверный формат команды. Ожидалось два регистра: " + textLine);
-                    }
-                } else {
-                    // One byte value
-                    try {
-                        int value = std::stoi(codeLine.getFirstOperand());
-                        if (value < 0 || value > 255) {
-                            throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (0-255): " + textLine);
-                        }
-                        overflowCheck(ip_ + 2, textLine);
-                        std::stringstream ss;
-                        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                           << " " << std::setw(2) << (command.getCode() * 4 + 0)
-                           << " " << std::setw(2) << value;
-                        firstPassLine = ss.str();
-                        ip_ += 2;
-                    } catch (const std::exception&) {
-                        throw AssemblerException("Невозможно преобразовать первый операнд в число: " + textLine);
-                    }
-                }
-                break;
+    for (auto& chunk : chunks) {
+        for (size_t i = 0; i < chunk.lines.size(); ++i) {
+            addToLineTable(chunk.lines[i], chunk.begin + i, chunk.section);
+        }
+        for (size_t i = 0; i < chunk.tsi.size(); ++i) {
+            if (!chunk.merged[i]) {
+                tsi_.add(chunk.tsi.getName(i), chunk.tsi.getAddress(i), chunk.section, chunk.tsi.getKind(i));
+            }
+        }
+        firstPassCode.insert(firstPassCode.end(), std::make_move_iterator(chunk.firstPassCode.begin()),
+                             std::make_move_iterator(chunk.firstPassCode.end()));
+    }
 
-            case 4:
-                if (!codeLine.hasFirstOperand()) {
-                    throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
-                }
-                if (codeLine.hasSecondOperand()) {
-                    throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
-                }
+    // All names are in the TSI now, so no site is a forward one
+    std::vector<ForwardSite> forwardSites;
+    for (const auto& chunk : chunks) {
+        for (size_t i = 0; i < chunk.lines.size(); ++i) {
+            addToCrossReference(chunk.lines[i], chunk.begin + i, chunk.section, forwardSites);
+        }
+    }
+    buildCrossReference(forwardSites);
 
-                // Check for relative addressing [LABEL]
-                if (isRelativeLabel(codeLine.getFirstOperand())) {
-                    if (addressingMode == "Straight") {
-                        throw AssemblerException("Данный тип адресации недоступен в этом режиме адресации: " + textLine);
-                    }
-                    
-                    overflowCheck(ip_ + 4, textLine);
-                    std::stringstream ss;
-                    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                       << " " << std::setw(2) << (command.getCode() * 4 + 2)
-                       << " " << codeLine.getFirstOperand();
-                    firstPassLine = ss.str();
-                    ip_ += 4;
-                } else if (isLabel(codeLine.getFirstOperand())) {
-                    // Direct addressing with label
-                    if (addressingMode == "Relative") {
-                        throw AssemblerException("Данный тип адресации недоступен в этом режиме адресации: " + textLine);
-                    }
-                    
-                    overflowCheck(ip_ + 4, textLine);
-                    std::stringstream ss;
-                    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                       << " " << std::setw(2) << (command.getCode() * 4 + 1)
-                       << " " << codeLine.getFirstOperand();
-                    firstPassLine = ss.str();
-                    ip_ += 4;
-                } else {
-                    try {
-                        int value = std::stoi(codeLine.getFirstOperand());
-                        if (value < 0 || value > 16777215) {
-                            throw AssemblerException("Недопустимое значение операнда: " + textLine);
-                        }
-                        overflowCheck(ip_ + 4, textLine);
-                        std::stringstream ss;
-                        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_
-                           << " " << std::setw(2) << (command.getCode() * 4)
-                           << " " << std::setw(6) << value;
-                        firstPassLine = ss.str();
-                        ip_ += 4;
-                    } catch (const std::exception&) {
-                        throw AssemblerException("Недопустимое значение операнда: " + textLine);
-                    }
-                }
-                break;
+    ip_ = chunks.back().ip;
+    currentSection_ = section;
+    sectionIndex_ = sections_.size() - 1;
+
+    tsiCheck();
+
+    return true;
+}
+
+void Assembler::firstPassChunk(const std::vector<std::vector<std::string>>& lines, const std::string& sectionName,
+                                            AddressingMode addressingMode, size_t shardCount, FirstPassChunk& chunk) const
+{
+    Assembler assembler;
+    assembler.setCommandTable(commandTable_);
+
+    // Only the first chunk of the program checks START
+    FirstPassState state;
+    if (chunk.begin != 0) {
+        state.startFlag = true;
+        state.firstMeaningfulLine = false;
+    }
+
+    // EXTDEF and EXTREF check the command of the previous line
+    if (!chunk.startsSection) {
+        assembler.currentSection_.setName(sectionName);
+        try {
+            state.previousDirective = directiveFromName(Parser::parseCodeLine(lines[chunk.begin - 1]).getCommand());
+        } catch (const AssemblerException&) {
+            chunk.failed = true;
+            return;
+        }
+    }
+
+    try {
+        for (size_t i = chunk.begin; i < chunk.end && !state.endFlag; ++i) {
+            chunk.lines.push_back(assembler.translateLine(lines[i], addressingMode, state));
+        }
+    } catch (const std::exception&) {
+        chunk.failed = true;
+        return;
+    }
+
+    chunk.tsi = std::move(assembler.tsi_);
+    chunk.merged.assign(chunk.tsi.size(), 0);
+    chunk.shards.resize(shardCount);
+    for (size_t i = 0; i < chunk.tsi.size(); ++i) {
+        chunk.shards[std::hash<std::string_view>()(chunk.tsi.getName(i)) % shardCount].push_back(i);
+    }
+
+    chunk.currentSection = assembler.currentSection_;
+    chunk.ip = assembler.ip_;
+    chunk.endFlag = state.endFlag;
+}
+
+bool Assembler::mergeChunkSymbols(std::vector<FirstPassChunk>& chunks, size_t shard, size_t sectionCount) const
+{
+    // As in pushToTSI, a name is defined once per section, except that a label
+    // gives its address to an EXTDEF name declared before it
+    // Names are views into the chunk name pools, which stay put while merging
+    std::vector<std::unordered_map<std::string_view, std::pair<SymbolTable*, size_t>>> names(sectionCount);
+
+    for (auto& chunk : chunks) {
+        SymbolTable& tsi = chunk.tsi;
+        for (size_t index : chunk.shards[shard]) {
+            if (tsi.getAddress(index) != -1) {
+                tsi.setAddress(index, tsi.getAddress(index) + chunk.offset);
+            }
+
+            auto inserted = names[chunk.section].emplace(tsi.getName(index), std::make_pair(&tsi, index));
+            if (inserted.second) {
+                continue;
+            }
+
+            SymbolTable& definedTsi = *inserted.first->second.first;
+            size_t defined = inserted.first->second.second;
+            if (definedTsi.getKind(defined) != SymbolicName::EXTDEF || definedTsi.getAddress(defined) != -1
+                || tsi.getKind(index) != SymbolicName::LOCAL) {
+                return false;
             }
+            definedTsi.setAddress(defined, tsi.getAddress(index));
+            chunk.merged[index] = 1;
         }
-        // If we reach here, the command was processed successfully
+    }
 
-        previousCommand = codeLine.getCommand();
-        firstPassCode.push_back(firstPassLine);
+    return true;
+}
+
+Assembler::TranslatedLine Assembler::translateLine(const std::vector<std::string>& line, AddressingMode addressingMode, FirstPassState& state)
+{
+    std::string textLine;
+    for (const auto& token : line) {
+        textLine += token + " ";
     }
 
-    if (!endFlag) {
-        throw AssemblerException("Не найдена точка входа в программу.");
+    if (!state.startFlag && ip_ != 0) {
+        throw AssemblerException("Не найдена директива START в начале программы");
     }
+
+    if (state.startFlag) {
+        overflowCheck(ip_, textLine);
+    }
+
+    TranslatedLine translated;
+    translated.codeLine = getCodeLineFromSource(line);
+    translated.address = ip_;
+    const CodeLine& codeLine = translated.codeLine;
     
-    tsiCheck();
+    if (codeLine.getCommand().empty()) {
+        throw AssemblerException("Пустая команда в строке: " + textLine);
+    }
+    
+    std::string upperCmd = codeLine.getCommand();
+    std::transform(upperCmd.begin(), upperCmd.end(), upperCmd.begin(), ::toupper);
 
-    return firstPassCode;
+    // Classified once; the switch below compiles to a jump table
+    Directive directive = directiveFromName(upperCmd);
+    
+    if (state.firstMeaningfulLine) {
+        if (directive != Directive::START) {
+            throw AssemblerException(
+                "Первая строка программы должна быть 'PROG START 0', "
+                "а не '" + upperCmd + "'. Строка: " + textLine
+                );
+        }
+        state.firstMeaningfulLine = false;
+    }
+
+    // Debug: Check what we're processing
+    bool isDir = directive != Directive::NONE;
+    bool isCmd = !isDir && isCommand(upperCmd);
+    
+    if (!isDir && !isCmd) {
+        std::string debugInfo = "Команда: '" + upperCmd + "', Оригинал: '" + codeLine.getCommand() + 
+                               "', isDirective: " + (isDir ? "true" : "false") + 
+                               ", isCommand: " + (isCmd ? "true" : "false");
+        throw AssemblerException("Неизвестная команда или директива. " + debugInfo + ". Строка: " + textLine);
+    }
+
+    // Labels of data, END and commands are addresses in the current section
+    switch (directive) {
+    case Directive::START:
+    case Directive::CSECT:
+    case Directive::EXTDEF:
+    case Directive::EXTREF:
+        break;
+    case Directive::END:
+        if (!state.startFlag || state.endFlag) {
+            throw AssemblerException("Не найдена метка START либо ошибка в директивах START/END: " + textLine);
+        }
+        [[fallthrough]];
+    default:
+        if (codeLine.hasLabel()) {
+            pushToTSI(codeLine.getLabel(), ip_, sectionIndex_, SymbolicName::LOCAL, textLine);
+        }
+        break;
+    }
+
+    switch (directive) {
+    case Directive::START:
+        processStartDirective(translated, textLine, state.startFlag);
+        break;
+    case Directive::CSECT:
+        processCsectDirective(translated, textLine);
+        break;
+    case Directive::EXTDEF:
+        processExtdefDirective(translated, textLine, state.previousDirective);
+        break;
+    case Directive::EXTREF:
+        processExtrefDirective(translated, textLine, state.previousDirective);
+        break;
+    case Directive::WORD:
+        processWordDirective(translated, textLine);
+        break;
+    case Directive::BYTE:
+        processByteDirective(translated, textLine);
+        break;
+    case Directive::RESW:
+        processReswDirective(translated, textLine);
+        break;
+    case Directive::RESB:
+        processResbDirective(translated, textLine);
+        break;
+    case Directive::END:
+        processEndDirective(translated, textLine);
+        state.endFlag = true;
+        return translated;
+    case Directive::NONE:
+        processCommand(translated, textLine, addressingMode);
+        break;
+    }
+
+    state.previousDirective = directive;
+    return translated;
+}
+
+std::string Assembler::formatFirstPassLine(const TranslatedLine& line) const
+{
+    const CodeLine& codeLine = line.codeLine;
+
+    std::stringstream ss;
+    switch (line.kind) {
+    case TranslatedLine::START_LINE:
+    case TranslatedLine::CSECT_LINE:
+        ss << codeLine.getLabel() << "\t" << codeLine.getCommand() << "\t" 
+           << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.value;
+        break;
+    case TranslatedLine::EXTDEF_LINE:
+        ss << "\t" << "EXTDEF" << "\t" << codeLine.getFirstOperand();
+        break;
+    case TranslatedLine::EXTREF_LINE:
+        ss << "\t" << "EXTREF" << "\t" << codeLine.getFirstOperand();
+        break;
+    case TranslatedLine::WORD_LINE:
+        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.address << " WORD " << std::setw(6) << line.value;
+        break;
+    case TranslatedLine::BYTE_LINE:
+        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.address << " BYTE ";
+        if (line.operandKind == TranslatedLine::STRING) {
+            ss << codeLine.getFirstOperand();
+        } else {
+            ss << std::setw(2) << line.value;
+        }
+        break;
+    case TranslatedLine::RESW_LINE:
+        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.address << " RESW " << std::setw(2) << line.value;
+        break;
+    case TranslatedLine::RESB_LINE:
+        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.address << " RESB " << std::setw(2) << line.value;
+        break;
+    case TranslatedLine::COMMAND_LINE:
+        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << line.address
+           << " " << std::setw(2) << line.opcode;
+        switch (line.operandKind) {
+        case TranslatedLine::REGISTERS:
+            ss << " " << codeLine.getFirstOperand() << " " << codeLine.getSecondOperand();
+            break;
+        case TranslatedLine::BYTE_VALUE:
+            ss << " " << std::setw(2) << line.value;
+            break;
+        case TranslatedLine::ADDRESS_VALUE:
+            ss << " " << std::setw(6) << line.value;
+            break;
+        case TranslatedLine::LABEL:
+        case TranslatedLine::RELATIVE_LABEL:
+            ss << " " << codeLine.getFirstOperand();
+            break;
+        default:
+            break;
+        }
+        break;
+    case TranslatedLine::END_LINE:
+        break;
+    }
+    return ss.str();
+}
+
+void Assembler::processCommand(TranslatedLine& line, const std::string& textLine, AddressingMode addressingMode)
+{
+    const CodeLine& codeLine = line.codeLine;
+
+    // Find the command
+    const Command* command = tokens_.classify(codeLine.getCommand()).command;
+
+    if (command == nullptr) {
+        throw AssemblerException("Неизвестная команда: " + textLine);
+    }
+
+    line.kind = TranslatedLine::COMMAND_LINE;
+    line.opcode = command->getCode() * 4;
+
+    switch (command->getLength()) {
+    case 1: {
+        if (codeLine.hasFirstOperand()) {
+            throw AssemblerException("Ожидается ноль операндов: " + textLine);
+        }
+        overflowCheck(ip_ + 1, textLine);
+        ip_ += 1;
+        break;
+    }
+    case 2:
+        if (!codeLine.hasFirstOperand()) {
+            throw AssemblerException("Ожидается минимум один операнд, но было получено ноль: " + textLine);
+        }
+
+        if (codeLine.hasSecondOperand()) {
+            // Two registers
+            if (isRegister(codeLine.getFirstOperand()) && isRegister(codeLine.getSecondOperand())) {
+                overflowCheck(ip_ + 2, textLine);
+                line.operandKind = TranslatedLine::REGISTERS;
+                ip_ += 2;
+            } else {
+                throw AssemblerException("Неверный формат команды. Ожидалось два регистра: " + textLine);
+            }
+        } else {
+            // One byte value; a value out of range or past the end of memory is reported as not a number
+            const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+            if (!operand.number || operand.value < 0 || operand.value > 255 || ip_ + 2 > MAX_ADDRESS) {
+                throw AssemblerException("Невозможно преобразовать первый операнд в число: " + textLine);
+            }
+            line.operandKind = TranslatedLine::BYTE_VALUE;
+            line.value = operand.value;
+            ip_ += 2;
+        }
+        break;
+
+    case 4:
+        if (!codeLine.hasFirstOperand()) {
+            throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
+        }
+        if (codeLine.hasSecondOperand()) {
+            throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
+        }
+
+        // Check for relative addressing [LABEL]
+        if (isRelativeLabel(codeLine.getFirstOperand())) {
+            if (addressingMode == AddressingMode::STRAIGHT) {
+                throw AssemblerException("Данный тип адресации недоступен в этом режиме адресации: " + textLine);
+            }
+            
+            overflowCheck(ip_ + 4, textLine);
+            line.operandKind = TranslatedLine::RELATIVE_LABEL;
+            line.opcode += 2;
+            ip_ += 4;
+        } else if (isLabel(codeLine.getFirstOperand())) {
+            // Direct addressing with label
+            if (addressingMode == AddressingMode::RELATIVE) {
+                throw AssemblerException("Данный тип адресации недоступен в этом режиме адресации: " + textLine);
+            }
+            
+            overflowCheck(ip_ + 4, textLine);
+            line.operandKind = TranslatedLine::LABEL;
+            line.opcode += 1;
+            ip_ += 4;
+        } else {
+            const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+            if (!operand.number || operand.value < 0 || operand.value > 16777215 || ip_ + 4 > MAX_ADDRESS) {
+                throw AssemblerException("Недопустимое значение операнда: " + textLine);
+            }
+            line.operandKind = TranslatedLine::ADDRESS_VALUE;
+            line.value = operand.value;
+            ip_ += 4;
+        }
+        break;
+    }
 }
 
-std::string Assembler::processStartDirective(const CodeLine& codeLine, const std::string& textLine, bool& startFlag)
+void Assembler::processStartDirective(TranslatedLine& line, const std::string& textLine, bool& startFlag)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (codeLine.hasSecondOperand()) {
         throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
     }
@@ -553,11 +916,11 @@ std::string Assembler::processStartDirective(const CodeLine& codeLine, const std
 
     int address = 0;
     if (codeLine.hasFirstOperand()) {
-        try {
-            address = std::stoi(codeLine.getFirstOperand());
-        } catch (const std::exception&) {
+        const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+        if (!operand.number) {
             throw AssemblerException("Невозможно преобразовать первый операнд в адрес начала программы: " + textLine);
         }
+        address = operand.value;
 
         if (address != 0) {
             throw AssemblerException("Адрес загрузки должен быть равен нулю: " + textLine);
@@ -571,17 +934,18 @@ std::string Assembler::processStartDirective(const CodeLine& codeLine, const std
     // Initialize currentSection
     currentSection_.setName(codeLine.getLabel());
     currentSection_.setStartAddress(address);
+    sectionIndex_ = sections_.size();
 
     ip_ = address;
 
-    std::stringstream ss;
-    ss << codeLine.getLabel() << "\t" << codeLine.getCommand() << "\t" 
-       << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << address;
-    return ss.str();
+    line.kind = TranslatedLine::START_LINE;
+    line.value = address;
 }
 
-std::string Assembler::processCsectDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processCsectDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (codeLine.hasSecondOperand()) {
         throw AssemblerException("Ожидается ноль или один операнд: " + textLine);
     }
@@ -592,11 +956,11 @@ std::string Assembler::processCsectDirective(const CodeLine& codeLine, const std
 
     int endAddress = 0;
     if (codeLine.hasFirstOperand()) {
-        try {
-            endAddress = std::stoi(codeLine.getFirstOperand());
-        } catch (const std::exception&) {
+        const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+        if (!operand.number) {
             throw AssemblerException("Невозможно преобразовать первый операнд в адрес входа в секцию: " + textLine);
         }
+        endAddress = operand.value;
 
         if (endAddress < 0 || endAddress > 16777215) {
             throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (0-16777215): " + textLine);
@@ -613,17 +977,18 @@ std::string Assembler::processCsectDirective(const CodeLine& codeLine, const std
     currentSection_.setStartAddress(0);
     currentSection_.setEndAddress(0);
     currentSection_.setLength(0);
+    sectionIndex_ = sections_.size();
 
     ip_ = 0;
 
-    std::stringstream ss;
-    ss << codeLine.getLabel() << "\t" << codeLine.getCommand() << "\t" 
-       << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << endAddress;
-    return ss.str();
+    line.kind = TranslatedLine::CSECT_LINE;
+    line.value = endAddress;
 }
 
-std::string Assembler::processExtdefDirective(const CodeLine& codeLine, const std::string& textLine, const std::string& previousCommand)
+void Assembler::processExtdefDirective(TranslatedLine& line, const std::string& textLine, Directive previousDirective)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -631,21 +996,21 @@ std::string Assembler::processExtdefDirective(const CodeLine& codeLine, const st
         throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
     }
 
-    orderCheck("EXTDEF", previousCommand, textLine);
+    orderCheck(Directive::EXTDEF, previousDirective, textLine);
 
     if (!isLabel(codeLine.getFirstOperand())) {
         throw AssemblerException("Операнд для директивы EXTDEF должен быть меткой: " + textLine);
     }
 
-    pushToTSI(codeLine.getFirstOperand(), -1, currentSection_.getName(), "ВИ", textLine);
+    pushToTSI(codeLine.getFirstOperand(), -1, sectionIndex_, SymbolicName::EXTDEF, textLine);
 
-    std::stringstream ss;
-    ss << "\t" << "EXTDEF" << "\t" << codeLine.getFirstOperand();
-    return ss.str();
+    line.kind = TranslatedLine::EXTDEF_LINE;
 }
 
-std::string Assembler::processExtrefDirective(const CodeLine& codeLine, const std::string& textLine, const std::string& previousCommand)
+void Assembler::processExtrefDirective(TranslatedLine& line, const std::string& textLine, Directive previousDirective)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -653,21 +1018,21 @@ std::string Assembler::processExtrefDirective(const CodeLine& codeLine, const st
         throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
     }
 
-    orderCheck("EXTREF", previousCommand, textLine);
+    orderCheck(Directive::EXTREF, previousDirective, textLine);
 
     if (!isLabel(codeLine.getFirstOperand())) {
         throw AssemblerException("Операнд для директивы EXTREF должен быть меткой: " + textLine);
     }
 
-    pushToTSI(codeLine.getFirstOperand(), -1, currentSection_.getName(), "ВС", textLine);
+    pushToTSI(codeLine.getFirstOperand(), -1, sectionIndex_, SymbolicName::EXTREF, textLine);
 
-    std::stringstream ss;
-    ss << "\t" << "EXTREF" << "\t" << codeLine.getFirstOperand();
-    return ss.str();
+    line.kind = TranslatedLine::EXTREF_LINE;
 }
 
-std::string Assembler::processWordDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processWordDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -677,11 +1042,11 @@ std::string Assembler::processWordDirective(const CodeLine& codeLine, const std:
     }
 
     int value;
-    try {
-        value = std::stoi(codeLine.getFirstOperand());
-    } catch (const std::exception&) {
+    const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+    if (!operand.number) {
         throw AssemblerException("Невозможно преобразовать первый операнд в число: " + textLine);
     }
+    value = operand.value;
 
     if (value <= 0 || value > 16777215) {
         throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (1-16777215): " + textLine);
@@ -689,14 +1054,15 @@ std::string Assembler::processWordDirective(const CodeLine& codeLine, const std:
 
     overflowCheck(ip_ + 3, textLine);
 
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " WORD " << std::setw(6) << value;
+    line.kind = TranslatedLine::WORD_LINE;
+    line.value = value;
     ip_ += 3;
-    return ss.str();
 }
 
-std::string Assembler::processByteDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processByteDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -705,47 +1071,37 @@ std::string Assembler::processByteDirective(const CodeLine& codeLine, const std:
         throw AssemblerException("Ожидается один операнд, но найдено два: " + textLine);
     }
 
-    const std::string& operand = codeLine.getFirstOperand();
-
-    // Try to parse as numeric value
-    try {
-        int value = std::stoi(operand);
-        if (value < 0 || value > 255) {
-            throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (0-255): " + textLine);
-        }
-
-        overflowCheck(ip_ + 1, textLine);
+    const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+    int symbols = static_cast<int>(codeLine.getFirstOperand().length()) - 3;
+    line.kind = TranslatedLine::BYTE_LINE;
 
-        std::stringstream ss;
-        ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " BYTE " << std::setw(2) << value;
+    // A number out of range or past the end of memory goes on to the string checks
+    if (operand.number && operand.value >= 0 && operand.value <= 255 && ip_ + 1 <= MAX_ADDRESS) {
+        line.operandKind = TranslatedLine::BYTE_VALUE;
+        line.value = operand.value;
+        line.length = 1;
         ip_ += 1;
-        return ss.str();
-    } catch (const std::exception&) {
-        // Try to parse as string
-        if (isCString(operand)) {
-            std::string symbols = operand.substr(2, operand.length() - 3);
-            overflowCheck(ip_ + symbols.length(), textLine);
-
-            std::stringstream ss;
-            ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " BYTE " << operand;
-            ip_ += symbols.length();
-            return ss.str();
-        } else if (isXString(operand)) {
-            std::string symbols = operand.substr(2, operand.length() - 3);
-            overflowCheck(ip_ + symbols.length() / 2, textLine);
-
-            std::stringstream ss;
-            ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " BYTE " << operand;
-            ip_ += symbols.length() / 2;
-            return ss.str();
-        } else {
-            throw AssemblerException("Невозможно преобразовать первый операнд в символьную или шестнадцатеричную строку: " + textLine);
-        }
+    } else if (operand.cString) {
+        overflowCheck(ip_ + symbols, textLine);
+
+        line.operandKind = TranslatedLine::STRING;
+        line.length = symbols;
+        ip_ += symbols;
+    } else if (operand.xString) {
+        overflowCheck(ip_ + symbols / 2, textLine);
+
+        line.operandKind = TranslatedLine::STRING;
+        line.length = symbols / 2;
+        ip_ += symbols / 2;
+    } else {
+        throw AssemblerException("Невозможно преобразовать первый операнд в символьную или шестнадцатеричную строку: " + textLine);
     }
 }
 
-std::string Assembler::processReswDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processReswDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -755,11 +1111,11 @@ std::string Assembler::processReswDirective(const CodeLine& codeLine, const std:
     }
 
     int value;
-    try {
-        value = std::stoi(codeLine.getFirstOperand());
-    } catch (const std::exception&) {
+    const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+    if (!operand.number) {
         throw AssemblerException("Невозможно преобразовать первый операнд в число: " + textLine);
     }
+    value = operand.value;
 
     if (value <= 0 || value > 255) {
         throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (1-255): " + textLine);
@@ -767,14 +1123,15 @@ std::string Assembler::processReswDirective(const CodeLine& codeLine, const std:
 
     overflowCheck(ip_ + value * 3, textLine);
 
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " RESW " << std::setw(2) << value;
+    line.kind = TranslatedLine::RESW_LINE;
+    line.value = value;
     ip_ += value * 3;
-    return ss.str();
 }
 
-std::string Assembler::processResbDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processResbDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (!codeLine.hasFirstOperand()) {
         throw AssemblerException("Ожидается один операнд, но было получено ноль: " + textLine);
     }
@@ -784,11 +1141,11 @@ std::string Assembler::processResbDirective(const CodeLine& codeLine, const std:
     }
 
     int value;
-    try {
-        value = std::stoi(codeLine.getFirstOperand());
-    } catch (const std::exception&) {
+    const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+    if (!operand.number) {
         throw AssemblerException("Невозможно преобразовать первый операнд в число: " + textLine);
     }
+    value = operand.value;
 
     if (value <= 0 || value > 255) {
         throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (1-255): " + textLine);
@@ -796,25 +1153,26 @@ std::string Assembler::processResbDirective(const CodeLine& codeLine, const std:
 
     overflowCheck(ip_ + value, textLine);
 
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << ip_ << " RESB " << std::setw(2) << value;
+    line.kind = TranslatedLine::RESB_LINE;
+    line.value = value;
     ip_ += value;
-    return ss.str();
 }
 
-std::string Assembler::processEndDirective(const CodeLine& codeLine, const std::string& textLine)
+void Assembler::processEndDirective(TranslatedLine& line, const std::string& textLine)
 {
+    const CodeLine& codeLine = line.codeLine;
+
     if (codeLine.hasSecondOperand()) {
         throw AssemblerException("Ожидается максимум один операнд, но найдено два: " + textLine);
     }
 
-    int endAddress = 0;
+    int endAddress = currentSection_.getStartAddress();
     if (codeLine.hasFirstOperand()) {
-        try {
-            endAddress = std::stoi(codeLine.getFirstOperand());
-        } catch (const std::exception&) {
+        const TokenClass& operand = tokens_.classify(codeLine.getFirstOperand());
+        if (!operand.number) {
             throw AssemblerException("Невозможно преобразовать первый операнд в адрес входа в программу: " + textLine);
         }
+        endAddress = operand.value;
 
         if (endAddress < 0 || endAddress > 16777215) {
             throw AssemblerException("Значение первого операнда выходит за границы допустимого диапазона (0-16777215): " + textLine);
@@ -828,7 +1186,8 @@ std::string Assembler::processEndDirective(const CodeLine& codeLine, const std::
     currentSection_.setLength(ip_ - currentSection_.getStartAddress());
     addSection(currentSection_);
 
-    return ""; // END directive doesn't produce output in first pass
+    line.kind = TranslatedLine::END_LINE;
+    line.value = endAddress;
 }
 
 CodeLine Assembler::getCodeLineFromSource(const std::vector<std::string>& line)
@@ -855,11 +1214,15 @@ std::vector<std::string> Assembler::secondPass(const std::vector<std::vector<std
         }
         
         std::string secondPassLine;
+        TextRecord text;
+        int listedAddress = -1; // Of the line in the listing, -1 for records without one
 
         // First line = start directive
         if (i == 0) {
             currentSection_ = sections_[0];
+            sectionIndex_ = 0;
             secondIp_ = currentSection_.getStartAddress();
+            listedAddress = secondIp_;
             
             std::stringstream ss;
             ss << "H " << codeLine.getLabel() << "\t"
@@ -875,23 +1238,24 @@ std::vector<std::string> Assembler::secondPass(const std::vector<std::vector<std
                 throw AssemblerException("Пустая команда во втором проходе: " + textLine);
             }
 
-            if (upperCmd == "CSECT") {
+            int lineAddress = secondIp_;
+            switch (directiveFromName(upperCmd)) {
+            case Directive::CSECT: {
                 // Handle CSECT inline (adds multiple records)
                 if (currentSection_.getEndAddress() < currentSection_.getStartAddress() || 
-                    currentSection_.getEndAddress() > currentSection_.getLength()) {
+                    currentSection_.getEndAddress() > currentSection_.getStartAddress() + currentSection_.getLength()) {
                     throw AssemblerException("Некорректный адрес входа в программу: " + std::to_string(currentSection_.getEndAddress()));
                 }
 
                 // Add modification records for previous section
                 for (const auto& tnLine : tn_) {
                     if (tnLine.getSection() == currentSection_.getName()) {
-                        std::stringstream ss;
-                        ss << "M " << tnLine.getAddress() << "\t" << (tnLine.getLabel().empty() ? "" : tnLine.getLabel());
-                        secondPassCode.push_back(ss.str());
+                        secondPassCode.push_back(modificationRecord(tnLine));
                     }
                 }
                 
-                // Add end record for previous section
+                // Add line and end records for previous section
+                pushLineRecord(sectionIndex, secondPassCode);
                 std::stringstream endSs;
                 endSs << "E " << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << currentSection_.getEndAddress();
                 secondPassCode.push_back(endSs.str());
@@ -899,7 +1263,9 @@ std::vector<std::string> Assembler::secondPass(const std::vector<std::vector<std
                 // Move to next section
                 sectionIndex++;
                 currentSection_ = sections_[sectionIndex];
+                sectionIndex_ = sectionIndex;
                 secondIp_ = currentSection_.getStartAddress();
+                listedAddress = secondIp_;
 
                 // Create header record for new section
                 std::stringstream ss;
@@ -907,20 +1273,28 @@ std::vector<std::string> Assembler::secondPass(const std::vector<std::vector<std
                    << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << currentSection_.getStartAddress()
                    << "\t" << std::setw(6) << currentSection_.getLength();
                 secondPassLine = ss.str();
-            } else if (upperCmd == "EXTDEF") {
+                break;
+            }
+            case Directive::EXTDEF:
                 secondPassLine = processSecondPassExtdef(codeLine, textLine);
-            } else if (upperCmd == "EXTREF") {
+                break;
+            case Directive::EXTREF:
                 secondPassLine = processSecondPassExtref(codeLine, textLine);
-            } else if (upperCmd == "WORD") {
-                secondPassLine = processSecondPassWord(codeLine);
+                break;
+            case Directive::WORD:
+                text = processSecondPassWord(codeLine);
                 secondIp_ += 3;
-            } else if (upperCmd == "BYTE") {
-                secondPassLine = processSecondPassByte(codeLine);
-            } else if (upperCmd == "RESB") {
-                secondPassLine = processSecondPassResb(codeLine);
-            } else if (upperCmd == "RESW") {
-                secondPassLine = processSecondPassResw(codeLine);
-            } else {
+                break;
+            case Directive::BYTE:
+                text = processSecondPassByte(codeLine);
+                break;
+            case Directive::RESB:
+                text = processSecondPassResb(codeLine);
+                break;
+            case Directive::RESW:
+                text = processSecondPassResw(codeLine);
+                break;
+            default: {
                 // This should be a machine command (with hex opcode)
                 // Check if it looks like a hex number
                 bool isHexCommand = true;
@@ -935,53 +1309,63 @@ std::vector<std::string> Assembler::secondPass(const std::vector<std::vector<std
                     throw AssemblerException("Неизвестная директива или команда: " + upperCmd + " в строке: " + textLine);
                 }
                 
-                secondPassLine = processSecondPassCommand(codeLine, textLine);
+                text = processSecondPassCommand(codeLine, textLine);
+                break;
+            }
+            }
+
+            if (!text.record.empty()) {
+                secondPassLine = std::move(text.record);
+                listedAddress = lineAddress;
             }
         }
 
+        if (listing_) {
+            listing_->writeLine(i, listedAddress, text.code);
+        }
         secondPassCode.push_back(secondPassLine);
     }
 
     // Add modification records and end record for the last section
     for (const auto& tnLine : tn_) {
         if (tnLine.getSection() == currentSection_.getName()) {
-            std::stringstream ss;
-            ss << "M " << tnLine.getAddress() << "\t" << (tnLine.getLabel().empty() ? "" : tnLine.getLabel());
-            secondPassCode.push_back(ss.str());
+            secondPassCode.push_back(modificationRecord(tnLine));
         }
     }
 
     if (currentSection_.getEndAddress() < currentSection_.getStartAddress() || 
-        currentSection_.getEndAddress() > currentSection_.getLength()) {
+        currentSection_.getEndAddress() > currentSection_.getStartAddress() + currentSection_.getLength()) {
         throw AssemblerException("Некорректный адрес входа в программу: " + std::to_string(currentSection_.getEndAddress()));
     }
 
+    pushLineRecord(sectionIndex, secondPassCode);
     std::stringstream ss;
     ss << "E " << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << currentSection_.getEndAddress();
     secondPassCode.push_back(ss.str());
 
+    if (listing_) {
+        listing_->finish(tsi_, sections_, crossReference_);
+    }
     return secondPassCode;
 }
 
 std::string Assembler::processSecondPassExtdef(const CodeLine& codeLine, const std::string& textLine)
 {
-    SymbolicName* symbolicName = getSymbolicName(codeLine.getFirstOperand(), currentSection_.getName());
+    int symbol = tsi_.find(codeLine.getFirstOperand(), sectionIndex_);
 
-    if (symbolicName == nullptr) {
+    if (symbol == -1) {
         throw AssemblerException("Метка не найдена в ТСИ: " + textLine);
     }
 
     std::stringstream ss;
     ss << "D " << codeLine.getFirstOperand() << "\t"
-       << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << symbolicName->getAddress();
+       << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << tsi_.getAddress(symbol);
     return ss.str();
 }
 
 std::string Assembler::processSecondPassExtref(const CodeLine& codeLine, const std::string& textLine)
 {
-    SymbolicName* symbolicName = getSymbolicName(codeLine.getFirstOperand(), currentSection_.getName());
-
-    if (symbolicName == nullptr) {
+    if (tsi_.find(codeLine.getFirstOperand(), sectionIndex_) == -1) {
         throw AssemblerException("Метка не найдена в ТСИ: " + textLine);
     }
 
@@ -990,16 +1374,23 @@ std::string Assembler::processSecondPassExtref(const CodeLine& codeLine, const s
     return ss.str();
 }
 
-std::string Assembler::processSecondPassWord(const CodeLine& codeLine)
+Assembler::TextRecord Assembler::textRecord(const CodeLine& codeLine, int length, std::string code, char separator)
 {
     std::stringstream ss;
-    ss << "T " << codeLine.getLabel() << " "
-       << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << 3
-       << " " << std::setw(6) << std::stoi(codeLine.getFirstOperand(), nullptr, 16);
-    return ss.str();
+    ss << "T " << codeLine.getLabel() << separator
+       << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << length
+       << separator << code;
+    return { ss.str(), std::move(code) };
 }
 
-std::string Assembler::processSecondPassByte(const CodeLine& codeLine)
+Assembler::TextRecord Assembler::processSecondPassWord(const CodeLine& codeLine)
+{
+    std::stringstream code;
+    code << std::hex << std::uppercase << std::setfill('0') << std::setw(6) << std::stoi(codeLine.getFirstOperand(), nullptr, 16);
+    return textRecord(codeLine, 3, code.str(), ' ');
+}
+
+Assembler::TextRecord Assembler::processSecondPassByte(const CodeLine& codeLine)
 {
     const std::string& operand = codeLine.getFirstOperand();
 
@@ -1011,42 +1402,30 @@ std::string Assembler::processSecondPassByte(const CodeLine& codeLine)
         std::string asciiHex = convertToASCII(symbols);
 
         secondIp_ += length;
-        
-        std::stringstream ss;
-        ss << "T " << codeLine.getLabel() << " "
-           << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << length
-           << " " << asciiHex;
-        return ss.str();
+        return textRecord(codeLine, length, asciiHex, ' ');
     } else if (isXString(operand)) {
         std::string symbols = operand.substr(2, operand.length() - 3);
         int length = symbols.length() / 2;
 
         secondIp_ += length;
-        
-        std::stringstream ss;
-        ss << "T " << codeLine.getLabel() << " "
-           << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << length
-           << " " << symbols;
-        return ss.str();
+        return textRecord(codeLine, length, symbols, ' ');
     } else {
         // Try to parse as numeric value
         try {
             int value = std::stoi(operand, nullptr, 16);
             
             secondIp_ += 1;
-            
-            std::stringstream ss;
-            ss << "T " << codeLine.getLabel() << " "
-               << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << 1
-               << " " << std::setw(2) << value;
-            return ss.str();
+
+            std::stringstream code;
+            code << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << value;
+            return textRecord(codeLine, 1, code.str(), ' ');
         } catch (const std::exception&) {
             throw AssemblerException("Невозможно преобразовать первый операнд в строку или число");
         }
     }
 }
 
-std::string Assembler::processSecondPassResb(const CodeLine& codeLine)
+Assembler::TextRecord Assembler::processSecondPassResb(const CodeLine& codeLine)
 {
     int length = std::stoi(codeLine.getFirstOperand(), nullptr, 16);
 
@@ -1055,10 +1434,10 @@ std::string Assembler::processSecondPassResb(const CodeLine& codeLine)
     std::stringstream ss;
     ss << "T " << codeLine.getLabel() << " "
        << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << length;
-    return ss.str();
+    return { ss.str(), {} }; // Reserved memory has no code
 }
 
-std::string Assembler::processSecondPassResw(const CodeLine& codeLine)
+Assembler::TextRecord Assembler::processSecondPassResw(const CodeLine& codeLine)
 {
     int length = std::stoi(codeLine.getFirstOperand(), nullptr, 16);
 
@@ -1067,10 +1446,10 @@ std::string Assembler::processSecondPassResw(const CodeLine& codeLine)
     std::stringstream ss;
     ss << "T " << codeLine.getLabel() << " "
        << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << (length * 3);
-    return ss.str();
+    return { ss.str(), {} };
 }
 
-std::string Assembler::processSecondPassCommand(const CodeLine& codeLine, const std::string& textLine)
+Assembler::TextRecord Assembler::processSecondPassCommand(const CodeLine& codeLine, const std::string& textLine)
 {
     int addressingType, commandCode;
     
@@ -1083,70 +1462,55 @@ std::string Assembler::processSecondPassCommand(const CodeLine& codeLine, const
     }
 
     // Find command by code
-    auto cmdIt = std::find_if(availableCommands_.begin(), availableCommands_.end(),
-                              [commandCode](const Command& cmd) {
-                                  return cmd.getCode() == commandCode;
-                              });
+    const Command* cmd = commandTable_->findByCode(commandCode);
     
-    if (cmdIt == availableCommands_.end()) {
+    if (cmd == nullptr) {
         throw AssemblerException("Неизвестная команда: " + textLine);
     }
     
-    const Command& command = *cmdIt;
+    const Command& command = *cmd;
 
     switch (addressingType) {
     case 0:
         if (!codeLine.hasFirstOperand() && !codeLine.hasSecondOperand()) {
             // Operandless command
             secondIp_ += command.getLength();
-            std::stringstream ss;
-            ss << "T " << codeLine.getLabel() << "\t"
-               << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << command.getLength()
-               << "\t" << codeLine.getCommand();
-            return ss.str();
+            return textRecord(codeLine, command.getLength(), codeLine.getCommand(), '\t');
         } else if (codeLine.hasSecondOperand()) {
             // Registers
             secondIp_ += command.getLength();
-            std::stringstream ss;
-            ss << "T " << codeLine.getLabel() << "\t"
-               << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << command.getLength()
-               << "\t" << codeLine.getCommand()
-               << std::hex << std::uppercase << std::setfill('0') << std::setw(1) << (getRegisterNumber(codeLine.getFirstOperand()) - 1)
-               << std::setw(1) << (getRegisterNumber(codeLine.getSecondOperand()) - 1);
-            return ss.str();
+            std::stringstream code;
+            code << codeLine.getCommand()
+                 << std::hex << std::uppercase << std::setfill('0') << std::setw(1) << (getRegisterNumber(codeLine.getFirstOperand()) - 1)
+                 << std::setw(1) << (getRegisterNumber(codeLine.getSecondOperand()) - 1);
+            return textRecord(codeLine, command.getLength(), code.str(), '\t');
         } else {
             // One operand
             secondIp_ += command.getLength();
-            std::stringstream ss;
-            ss << "T " << codeLine.getLabel() << "\t"
-               << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << command.getLength()
-               << "\t" << codeLine.getCommand() << codeLine.getFirstOperand();
-            return ss.str();
+            return textRecord(codeLine, command.getLength(), codeLine.getCommand() + codeLine.getFirstOperand(), '\t');
         }
 
     case 1:
     {
-        SymbolicName* symbolicName = getSymbolicName(codeLine.getFirstOperand(), currentSection_.getName());
-        if (symbolicName == nullptr) {
+        int symbol = tsi_.find(codeLine.getFirstOperand(), sectionIndex_);
+        if (symbol == -1) {
             throw AssemblerException("Метка не найдена в ТСИ: " + textLine);
         }
 
         secondIp_ += 4;
         
-        std::stringstream ss;
-        ss << "T " << codeLine.getLabel() << "\t"
-           << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << command.getLength()
-           << "\t" << codeLine.getCommand();
+        std::stringstream code;
+        code << codeLine.getCommand() << std::hex << std::uppercase << std::setfill('0');
            
-        if (symbolicName->getType() == "ВС") {
-            ss << std::setw(6) << 0;
+        if (tsi_.getKind(symbol) == SymbolicName::EXTREF) {
+            code << std::setw(6) << 0;
         } else {
-            ss << std::setw(6) << symbolicName->getAddress();
+            code << std::setw(6) << tsi_.getAddress(symbol);
         }
         
-        pushToTN(codeLine.getLabel(), symbolicName->getName(), currentSection_.getName());
+        pushToTN(codeLine.getLabel(), std::string(tsi_.getName(symbol)), currentSection_.getName());
         
-        return ss.str();
+        return textRecord(codeLine, command.getLength(), code.str(), '\t');
     }
 
     case 2:
@@ -1155,38 +1519,311 @@ std::string Assembler::processSecondPassCommand(const CodeLine& codeLine, const
         // Extract label from [LABEL]
         std::string labelName = codeLine.getFirstOperand().substr(1, codeLine.getFirstOperand().length() - 2);
         
-        SymbolicName* symbolicName = getSymbolicName(labelName, currentSection_.getName());
-        if (symbolicName == nullptr) {
+        int symbol = tsi_.find(labelName, sectionIndex_);
+        if (symbol == -1) {
             throw AssemblerException("Метка не найдена в ТСИ: " + textLine);
         }
         
-        if (symbolicName->getType() == "ВС") {
+        if (tsi_.getKind(symbol) == SymbolicName::EXTREF) {
             throw AssemblerException("Относительная адресация недопустима для внешних ссылок: " + textLine);
         }
 
         secondIp_ += 4;
         
         // Calculate relative offset
-        int relativeOffset = symbolicName->getAddress() - secondIp_;
+        int relativeOffset = tsi_.getAddress(symbol) - secondIp_;
         
-        std::stringstream ss;
-        ss << "T " << codeLine.getLabel() << "\t"
-           << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << command.getLength()
-           << "\t" << codeLine.getCommand();
+        std::stringstream code;
+        code << codeLine.getCommand() << std::hex << std::uppercase << std::setfill('0');
         
         // Handle negative offsets for two's complement representation
         if (relativeOffset < 0) {
             // Convert to 24-bit two's complement
             unsigned int unsignedOffset = (1 << 24) + relativeOffset;
-            ss << std::setw(6) << (unsignedOffset & 0xFFFFFF);
+            code << std::setw(6) << (unsignedOffset & 0xFFFFFF);
         } else {
-            ss << std::setw(6) << relativeOffset;
+            code << std::setw(6) << relativeOffset;
         }
         
-        return ss.str();
+        return textRecord(codeLine, command.getLength(), code.str(), '\t');
     }
 
     default:
         throw AssemblerException("Неизвестный тип адресации");
     }
 }
+
+std::vector<std::string> Assembler::assemble(const std::vector<std::vector<std::string>>& lines, const std::string& addressingMode)
+{
+    return assemble(lines, addressingModeFromName(addressingMode));
+}
+
+std::vector<std::string> Assembler::assemble(const std::vector<std::vector<std::string>>& lines, AddressingMode addressingMode)
+{
+    clearTSI();
+    clearTN();
+    clearSections();
+    lineTable_.clear();
+    crossReference_.clear();
+    tokens_.clear();
+
+    OnePassState state;
+    std::vector<ForwardSite> forwardSites;
+    ip_ = 0;
+    sectionIndex_ = 0;
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (state.endFlag) break;
+
+        TranslatedLine translated = translateLine(lines[i], addressingMode, state);
+        addToLineTable(translated, i, sections_.size());
+        addToCrossReference(translated, i, sections_.size(), forwardSites);
+
+        // A label defined here completes the records waiting for it
+        if (translated.kind != TranslatedLine::START_LINE && translated.kind != TranslatedLine::CSECT_LINE
+            && translated.codeLine.hasLabel()) {
+            resolveFixups(translated.codeLine.getLabel(), translated.address, state);
+        }
+
+        emitRecords(translated, i, state);
+
+        if (translated.kind == TranslatedLine::CSECT_LINE || translated.kind == TranslatedLine::END_LINE) {
+            // The entry address of the last section is checked after all records, as in secondPass
+            closeSectionRecords(translated.kind == TranslatedLine::END_LINE ? lines.size() : i, lines, state);
+
+            if (translated.kind == TranslatedLine::CSECT_LINE) {
+                state.headerRecord = state.records.size();
+                state.records.emplace_back();
+                secondIp_ = 0;
+            }
+        }
+    }
+
+    if (!state.endFlag) {
+        throw AssemblerException("Не найдена точка входа в программу.");
+    }
+
+    buildCrossReference(forwardSites);
+    tsiCheck();
+
+    if (!state.errorMessage.empty()) {
+        throw AssemblerException(state.errorMessage);
+    }
+
+    return std::move(state.records);
+}
+
+void Assembler::emitRecords(const TranslatedLine& line, size_t lineIndex, OnePassState& state)
+{
+    const CodeLine& codeLine = line.codeLine;
+    std::vector<std::string>& records = state.records;
+
+    switch (line.kind) {
+    case TranslatedLine::START_LINE:
+        // The header is written when the section length is known
+        state.headerRecord = records.size();
+        records.emplace_back();
+        secondIp_ = line.value;
+        break;
+
+    case TranslatedLine::EXTDEF_LINE:
+        records.push_back("D " + codeLine.getFirstOperand() + "\t");
+        emitSymbolReference(codeLine.getFirstOperand(), Fixup::DEFINITION, lineIndex, state);
+        break;
+
+    case TranslatedLine::EXTREF_LINE:
+        records.push_back("R " + codeLine.getFirstOperand());
+        break;
+
+    case TranslatedLine::WORD_LINE:
+        records.push_back("T " + toHex(line.address, 6) + " 03 " + toHex(line.value, 6));
+        secondIp_ += 3;
+        break;
+
+    case TranslatedLine::BYTE_LINE: {
+        std::string record = "T " + toHex(line.address, 6) + " " + toHex(line.length, 2) + " ";
+        const std::string& operand = codeLine.getFirstOperand();
+        if (line.operandKind != TranslatedLine::STRING) {
+            record += toHex(line.value, 2);
+        } else if (operand[0] == 'C') {
+            LiteralCodec::encodeHex(operand.data() + 2, operand.length() - 3, record);
+        } else {
+            record.append(operand, 2, operand.length() - 3);
+        }
+        records.push_back(record);
+        secondIp_ += line.length;
+        break;
+    }
+
+    case TranslatedLine::RESB_LINE:
+        records.push_back("T " + toHex(line.address, 6) + " " + toHex(line.value, 2));
+        secondIp_ += line.value;
+        break;
+
+    case TranslatedLine::RESW_LINE:
+        records.push_back("T " + toHex(line.address, 6) + " " + toHex(line.value * 3, 2));
+        secondIp_ += line.value * 3;
+        break;
+
+    case TranslatedLine::COMMAND_LINE:
+        emitCommandRecord(line, lineIndex, state);
+        break;
+
+    case TranslatedLine::CSECT_LINE:
+    case TranslatedLine::END_LINE:
+        break; // Section records are closed by the caller
+    }
+}
+
+void Assembler::emitCommandRecord(const TranslatedLine& line, size_t lineIndex, OnePassState& state)
+{
+    const CodeLine& codeLine = line.codeLine;
+    std::string textLine = formatFirstPassLine(line) + " ";
+
+    // The command is looked up by code, as the second pass reads it from the first pass output
+    const Command* command = commandTable_->findByCode((line.opcode & 0xFC) >> 2);
+
+    if (command == nullptr) {
+        deferError(lineIndex, "Неизвестная команда: " + textLine, state);
+        state.records.emplace_back();
+        return;
+    }
+
+    std::string record = "T " + toHex(line.address, 6) + "\t" + toHex(command->getLength(), 2) + "\t" + toHex(line.opcode, 2);
+
+    switch (line.opcode & 0x03) {
+    case 0:
+        if (line.operandKind == TranslatedLine::REGISTERS) {
+            record += toHex(getRegisterNumber(codeLine.getFirstOperand()) - 1, 1);
+            record += toHex(getRegisterNumber(codeLine.getSecondOperand()) - 1, 1);
+        } else if (line.operandKind == TranslatedLine::BYTE_VALUE) {
+            record += toHex(line.value, 2);
+        } else if (line.operandKind == TranslatedLine::ADDRESS_VALUE) {
+            record += toHex(line.value, 6);
+        }
+        secondIp_ += command->getLength();
+        state.records.push_back(record);
+        break;
+
+    case 1: {
+        secondIp_ += 4;
+        state.records.push_back(record);
+        emitSymbolReference(codeLine.getFirstOperand(), Fixup::DIRECT, lineIndex, state);
+
+        std::string upperName = codeLine.getFirstOperand();
+        std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+        pushToTN(toHex(line.address, 6), upperName, currentSection_.getName());
+        break;
+    }
+
+    case 2: {
+        std::string labelName = codeLine.getFirstOperand().substr(1, codeLine.getFirstOperand().length() - 2);
+        int symbol = tsi_.find(labelName, sectionIndex_);
+        if (symbol != -1 && tsi_.getKind(symbol) == SymbolicName::EXTREF) {
+            deferError(lineIndex, "Относительная адресация недопустима для внешних ссылок: " + textLine, state);
+        }
+
+        secondIp_ += 4;
+        state.records.push_back(record);
+        emitSymbolReference(labelName, Fixup::RELATIVE, lineIndex, state);
+        break;
+    }
+    }
+}
+
+void Assembler::emitSymbolReference(const std::string& name, Fixup::Kind kind, size_t lineIndex, OnePassState& state)
+{
+    // Completes the last record with the symbol value or chains a fixup for it
+    std::string& record = state.records.back();
+    int symbol = tsi_.find(name, sectionIndex_);
+
+    if (symbol != -1 && tsi_.getKind(symbol) == SymbolicName::EXTREF) {
+        record += "000000";
+        return;
+    }
+
+    if (symbol != -1 && tsi_.getAddress(symbol) != -1) {
+        int value = tsi_.getAddress(symbol);
+        if (kind == Fixup::RELATIVE) {
+            value = (value - secondIp_) & 0xFFFFFF; // 24-bit two's complement
+        }
+        record += toHex(value, 6);
+        return;
+    }
+
+    record += "000000";
+
+    // Operands that name symbols are labels, which always fit a key
+    auto chain = state.fixupChains.emplace(LabelKey(name), -1).first;
+    state.fixups.push_back({ kind, state.records.size() - 1, lineIndex, secondIp_, chain->second });
+    chain->second = static_cast<int>(state.fixups.size() - 1);
+}
+
+void Assembler::resolveFixups(const std::string& name, int address, OnePassState& state)
+{
+    // Longer labels are never referenced
+    if (!LabelKey::fits(name)) return;
+
+    auto chain = state.fixupChains.find(LabelKey(name));
+    if (chain == state.fixupChains.end()) return;
+
+    for (int i = chain->second; i != -1; i = state.fixups[i].next) {
+        const Fixup& fixup = state.fixups[i];
+        int value = address;
+        if (fixup.kind == Fixup::RELATIVE) {
+            value = (address - fixup.base) & 0xFFFFFF;
+        }
+
+        std::string& record = state.records[fixup.record];
+        record.replace(record.size() - 6, 6, toHex(value, 6));
+    }
+
+    state.fixupChains.erase(chain);
+}
+
+void Assembler::closeSectionRecords(size_t lineIndex, const std::vector<std::vector<std::string>>& lines, OnePassState& state)
+{
+    const Section& section = sections_.back();
+    std::vector<std::string>& records = state.records;
+
+    // References left in the chains name no label of this section
+    for (const auto& chain : state.fixupChains) {
+        for (int i = chain.second; i != -1; i = state.fixups[i].next) {
+            const Fixup& fixup = state.fixups[i];
+            if (fixup.kind == Fixup::DEFINITION) continue; // Reported by tsiCheck
+
+            const std::string& record = records[fixup.record];
+            size_t opcodeStart = record.find('\t', 9) + 1;
+            std::string textLine = record.substr(2, 6) + " "
+                + record.substr(opcodeStart, record.size() - 6 - opcodeStart) + " "
+                + getCodeLineFromSource(lines[fixup.line]).getFirstOperand() + " ";
+            deferError(fixup.line, "Метка не найдена в ТСИ: " + textLine, state);
+        }
+    }
+    state.fixupChains.clear();
+    state.fixups.clear();
+
+    records[state.headerRecord] = "H " + section.getName() + "\t" + toHex(section.getStartAddress(), 6)
+        + "\t" + toHex(section.getLength(), 6);
+
+    if (section.getEndAddress() < section.getStartAddress() ||
+        section.getEndAddress() > section.getStartAddress() + section.getLength()) {
+        deferError(lineIndex, "Некорректный адрес входа в программу: " + std::to_string(section.getEndAddress()), state);
+    }
+
+    for (size_t i = state.sectionTN; i < tn_.size(); ++i) {
+        records.push_back(modificationRecord(tn_[i]));
+    }
+    state.sectionTN = tn_.size();
+
+    pushLineRecord(sections_.size() - 1, records);
+    records.push_back("E " + toHex(section.getEndAddress(), 6));
+}
+
+void Assembler::deferError(size_t lineIndex, const std::string& message, OnePassState& state)
+{
+    if (state.errorMessage.empty() || lineIndex < state.errorLine) {
+        state.errorLine = lineIndex;
+        state.errorMessage = message;
+    }
+}
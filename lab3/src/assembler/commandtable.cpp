@@ -0,0 +1,107 @@
+#include "assembler/commandtable.h"
+#include "exceptions/assemblerexception.h"
+#include "parser/parser.h"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+
+namespace {
+
+// Tables of the texts seen last; the UI and the batch driver usually have one or two
+const size_t MAX_CACHED_TABLES = 16;
+
+struct CachedTable
+{
+    std::string text;
+    std::shared_ptr<const CommandTable> table;
+};
+
+std::mutex cacheMutex;
+std::unordered_multimap<uint64_t, CachedTable> cache;
+
+} // namespace
+
+CommandTable::CommandTable(const std::vector<Command>& commands)
+    : commands_(commands)
+{
+    indexByKey_.reserve(commands_.size());
+    indexByCode_.reserve(commands_.size());
+
+    // Check name uniqueness
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        const std::string& name = commands_[i].getName();
+        bool inserted;
+        if (LabelKey::fits(name)) {
+            inserted = indexByKey_.emplace(LabelKey(name), i).second;
+        } else {
+            std::string upperName = name;
+            std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+            inserted = indexByName_.emplace(upperName, i).second;
+        }
+        if (!inserted) {
+            throw AssemblerException("Все имена команд должны быть уникальными");
+        }
+    }
+
+    // Check code uniqueness
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        if (!indexByCode_.emplace(commands_[i].getCode(), i).second) {
+            throw AssemblerException("Все коды команд должны быть уникальными");
+        }
+    }
+}
+
+std::shared_ptr<const CommandTable> CommandTable::fromText(const std::string& text)
+{
+    uint64_t hash = contentHash(text);
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto range = cache.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.text == text) {
+                return it->second.table;
+            }
+        }
+    }
+
+    // Invalid texts throw here and are not cached
+    auto table = std::make_shared<const CommandTable>(Parser::textToCommands(text));
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cache.size() >= MAX_CACHED_TABLES) {
+        cache.clear();
+    }
+    cache.emplace(hash, CachedTable{ text, table });
+    return table;
+}
+
+uint64_t CommandTable::contentHash(std::string_view text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+const Command* CommandTable::findByName(const std::string& name) const
+{
+    if (LabelKey::fits(name)) {
+        auto it = indexByKey_.find(LabelKey(name));
+        return it != indexByKey_.end() ? &commands_[it->second] : nullptr;
+    }
+
+    std::string upperName = name;
+    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+
+    auto it = indexByName_.find(upperName);
+    return it != indexByName_.end() ? &commands_[it->second] : nullptr;
+}
+
+const Command* CommandTable::findByCode(int code) const
+{
+    auto it = indexByCode_.find(code);
+    return it != indexByCode_.end() ? &commands_[it->second] : nullptr;
+}
@@ -0,0 +1,46 @@
+#include "assembler/directive.h"
+#include <cctype>
+
+namespace {
+
+// upper is an upper-case literal of the same length as name
+bool equalsUpper(const std::string& name, const char* upper)
+{
+    for (size_t i = 0; i < name.length(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(name[i])) != upper[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Directive directiveFromName(const std::string& name)
+{
+    switch (name.length()) {
+    case 3:
+        if (equalsUpper(name, "END")) return Directive::END;
+        break;
+    case 4:
+        if (equalsUpper(name, "WORD")) return Directive::WORD;
+        if (equalsUpper(name, "BYTE")) return Directive::BYTE;
+        if (equalsUpper(name, "RESB")) return Directive::RESB;
+        if (equalsUpper(name, "RESW")) return Directive::RESW;
+        break;
+    case 5:
+        if (equalsUpper(name, "START")) return Directive::START;
+        if (equalsUpper(name, "CSECT")) return Directive::CSECT;
+        break;
+    case 6:
+        if (equalsUpper(name, "EXTDEF")) return Directive::EXTDEF;
+        if (equalsUpper(name, "EXTREF")) return Directive::EXTREF;
+        break;
+    }
+    return Directive::NONE;
+}
+
+AddressingMode addressingModeFromName(const std::string& name)
+{
+    if (name == "Straight") return AddressingMode::STRAIGHT;
+    if (name == "Relative") return AddressingMode::RELATIVE;
+    return AddressingMode::MIXED;
+}
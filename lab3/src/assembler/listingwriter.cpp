@@ -0,0 +1,128 @@
+#include "assembler/listingwriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+ListingWriter::ListingWriter(std::ostream& out, std::string_view source, const std::vector<size_t>& lineNumbers)
+    : out_(out), source_(source), lineNumbers_(lineNumbers), position_(0), nextLine_(0)
+{
+    out_ << "Строка  Адрес   Код               Текст\n";
+}
+
+void ListingWriter::writeLine(size_t line, int address, std::string_view code)
+{
+    size_t target = sourceLine(line);
+    while (nextLine_ < target && position_ < source_.size()) {
+        writeSourceLine({}, -1);
+    }
+
+    if (nextLine_ == target && position_ < source_.size()) {
+        writeSourceLine(code, address);
+    } else {
+        writeText(address, code, target + 1, {}); // Not in the source as given
+    }
+}
+
+void ListingWriter::finish(const SymbolTable& symbols, const SectionTable& sections, const CrossReference& crossReference)
+{
+    while (position_ < source_.size()) {
+        writeSourceLine({}, -1);
+    }
+    if (symbols.empty()) {
+        return;
+    }
+
+    std::vector<size_t> order(symbols.size());
+    size_t nameWidth = 3;    // "Имя"
+    size_t sectionWidth = 6; // "Секция"
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        order[i] = i;
+        nameWidth = std::max(nameWidth, symbols.getName(i).size());
+        sectionWidth = std::max(sectionWidth, sections[symbols.getSection(i)].getName().size());
+    }
+    std::sort(order.begin(), order.end(), [&symbols, &sections](size_t a, size_t b) {
+        int names = symbols.getName(a).compare(symbols.getName(b));
+        return names != 0 ? names < 0 : sections[symbols.getSection(a)].getName() < sections[symbols.getSection(b)].getName();
+    });
+
+    out_ << "\nПерекрёстные ссылки\n"
+         << "Имя" << std::string(nameWidth - 3 + 2, ' ')
+         << "Секция" << std::string(sectionWidth - 6 + 2, ' ')
+         << "Адрес   Тип Строки\n";
+
+    char address[16];
+    for (size_t index : order) {
+        std::string_view name = symbols.getName(index);
+        const std::string& section = sections[symbols.getSection(index)].getName();
+        int value = symbols.getAddress(index);
+        if (value >= 0) {
+            std::snprintf(address, sizeof(address), "%06X", value);
+        } else {
+            std::snprintf(address, sizeof(address), "%6s", "");
+        }
+
+        std::string line(name);
+        line.append(nameWidth - name.size() + 2, ' ');
+        line += section;
+        line.append(sectionWidth - section.size() + 2, ' ');
+        line += address;
+        line += "  ";
+        const std::string& type = SymbolicName::typeName(symbols.getKind(index));
+        line += type.empty() ? std::string("  ") : type; // Two letters wide
+        line += ' ';
+        for (const CrossReference::Site& site : crossReference.getSites(index)) {
+            line += ' ';
+            line += std::to_string(site.line());
+            if (site.isDefinition()) line += '*';
+        }
+        line.erase(line.find_last_not_of(' ') + 1);
+        out_ << line << '\n';
+    }
+}
+
+size_t ListingWriter::sourceLine(size_t line) const
+{
+    return line < lineNumbers_.size() ? lineNumbers_[line] - 1 : line;
+}
+
+void ListingWriter::writeSourceLine(std::string_view code, int address)
+{
+    size_t end = source_.find('\n', position_);
+    if (end == std::string_view::npos) end = source_.size();
+    std::string_view text = source_.substr(position_, end - position_);
+    if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+
+    writeText(address, code, nextLine_ + 1, text);
+    position_ = end + 1;
+    ++nextLine_;
+}
+
+void ListingWriter::writeText(int address, std::string_view code, size_t number, std::string_view text)
+{
+    const size_t digitsPerLine = BYTES_PER_LINE * 2;
+    char prefix[64];
+
+    for (size_t offset = 0; offset == 0 || offset < code.size(); offset += digitsPerLine) {
+        std::string_view part = code.substr(std::min(offset, code.size()), digitsPerLine);
+        int length = 0;
+        if (offset == 0) {
+            length = std::snprintf(prefix, sizeof(prefix), "%6zu  ", number);
+        } else {
+            length = std::snprintf(prefix, sizeof(prefix), "%6s  ", "");
+        }
+        if (address >= 0) {
+            length += std::snprintf(prefix + length, sizeof(prefix) - length, "%06X  ", static_cast<unsigned int>(address + offset / 2));
+        } else {
+            length += std::snprintf(prefix + length, sizeof(prefix) - length, "%6s  ", "");
+        }
+        std::snprintf(prefix + length, sizeof(prefix) - length, "%-*.*s  ", static_cast<int>(digitsPerLine),
+                      static_cast<int>(part.size()), part.data());
+
+        std::string line(prefix);
+        if (offset == 0) {
+            line += text;
+        }
+        line.erase(line.find_last_not_of(' ') + 1);
+        out_ << line << '\n';
+    }
+}
@@ -0,0 +1,39 @@
+#include "assembler/literalcodec.h"
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+} // namespace
+
+bool LiteralCodec::isPrintable(const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c < 32 || c > 126) return false;
+    }
+    return true;
+}
+
+// Same set as std::isxdigit in the "C" locale
+bool LiteralCodec::isHexDigits(const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        bool digit = c >= '0' && c <= '9';
+        bool letter = (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+        if (!digit && !letter) return false;
+    }
+    return true;
+}
+
+void LiteralCodec::encodeHex(const char* data, size_t size, std::string& out)
+{
+    size_t start = out.size();
+    out.resize(start + 2 * size);
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        out[start + 2 * i] = HEX_DIGITS[c >> 4];
+        out[start + 2 * i + 1] = HEX_DIGITS[c & 0xF];
+    }
+}
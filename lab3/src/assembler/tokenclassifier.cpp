@@ -0,0 +1,89 @@
+#include "assembler/tokenclassifier.h"
+#include "assembler/literalcodec.h"
+#include "parser/parser.h"
+#include <cctype>
+#include <charconv>
+
+namespace {
+
+// Same numbers as std::stoi without the exceptions: optional leading whitespace and sign, then
+// decimal digits up to the first other character. False if there are none or the value is not an int.
+bool parseInt(const std::string& token, int& value)
+{
+    const char* begin = token.data();
+    const char* end = begin + token.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+    if (begin < end && *begin == '+') {
+        ++begin;
+        if (begin == end || !std::isdigit(static_cast<unsigned char>(*begin))) return false;
+    }
+    return std::from_chars(begin, end, value).ec == std::errc();
+}
+
+} // namespace
+
+TokenClassifier::TokenClassifier()
+{
+}
+
+TokenClassifier::TokenClassifier(std::shared_ptr<const CommandTable> commandTable)
+    : commandTable_(std::move(commandTable))
+{
+}
+
+TokenClass TokenClassifier::classify(const std::string& token) const
+{
+    auto it = classes_.find(token);
+    if (it != classes_.end()) {
+        return it->second;
+    }
+
+    TokenClass result = compute(token);
+    if (classes_.size() >= MAX_CACHED) {
+        classes_.clear();
+    }
+    classes_.emplace(token, result);
+    return result;
+}
+
+TokenClass TokenClassifier::compute(const std::string& token) const
+{
+    TokenClass result;
+    if (token.empty()) {
+        return result;
+    }
+
+    result.registerNumber = Parser::registerNumber(token);
+    result.command = commandTable_ ? commandTable_->findByName(token) : nullptr;
+    result.directive = directiveFromName(token);
+
+    result.number = parseInt(token, result.value);
+
+    // Up to 10 letters, digits and underscores starting with a letter
+    if (token.length() <= 10 && std::isalpha(static_cast<unsigned char>(token[0]))) {
+        result.label = true;
+        for (char c : token) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                result.label = false;
+                break;
+            }
+        }
+        result.label = result.label && result.registerNumber == 0 && result.command == nullptr
+            && result.directive == Directive::NONE;
+    }
+
+    size_t length = token.length();
+    if (length >= 3 && token.front() == '[' && token.back() == ']') {
+        result.relativeLabel = classify(token.substr(1, length - 2)).label;
+    }
+
+    if (length >= 4 && token[1] == '"' && token.back() == '"') {
+        if (token[0] == 'C') {
+            result.cString = LiteralCodec::isPrintable(token.data() + 2, length - 3);
+        } else if (token[0] == 'X') {
+            result.xString = (length - 3) % 2 == 0 && LiteralCodec::isHexDigits(token.data() + 2, length - 3);
+        }
+    }
+
+    return result;
+}
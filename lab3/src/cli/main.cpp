@@ -0,0 +1,175 @@
+#include "assembler/assembler.h"
+#include "io/mappedfile.h"
+#include "parser/parser.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// Headless assembler: sources are memory-mapped and lexed in place.
+// Several sources are assembled one after another (batch mode).
+
+namespace {
+
+struct Options
+{
+    AddressingMode addressingMode = AddressingMode::STRAIGHT;
+    std::string commandsPath;
+    std::string outputPath;
+    bool onePass = false;
+    bool lineRecords = false;
+    bool listing = false;
+    std::vector<std::string> sources;
+};
+
+void printUsage()
+{
+    std::cerr <<
+        "Использование: AssemblerCli [параметры] <исходный файл>...\n"
+        "  -m, --mode <Straight|Relative|Mixed>              режим адресации (по умолчанию Straight)\n"
+        "  -c, --commands <файл>                             таблица команд: имя, код и длина в hex\n"
+        "  -o, --output <файл>                               объектный файл для одного исходника, '-' - stdout\n"
+        "      --one-pass                                    ассемблирование за один просмотр\n"
+        "      --lines                                       записи L с таблицей строк для профилировщика\n"
+        "      --listing                                     листинг в <исходный файл>.lst (только в два прохода)\n"
+        "Без -o объектный код каждого исходника пишется в <исходный файл>.obj\n";
+}
+
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if ((argument == "-m" || argument == "--mode") && hasValue) {
+            std::string mode = argv[++i];
+            if (mode != "Straight" && mode != "Relative" && mode != "Mixed") {
+                return false;
+            }
+            options.addressingMode = addressingModeFromName(mode);
+        } else if ((argument == "-c" || argument == "--commands") && hasValue) {
+            options.commandsPath = argv[++i];
+        } else if ((argument == "-o" || argument == "--output") && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (argument == "--one-pass") {
+            options.onePass = true;
+        } else if (argument == "--lines") {
+            options.lineRecords = true;
+        } else if (argument == "--listing") {
+            options.listing = true;
+        } else if (!argument.empty() && argument[0] == '-') {
+            return false;
+        } else {
+            options.sources.push_back(argument);
+        }
+    }
+
+    return !options.sources.empty() && (options.outputPath.empty() || options.sources.size() == 1)
+        && !(options.listing && options.onePass);
+}
+
+std::vector<std::string> assembleSource(const Options& options, const std::shared_ptr<const CommandTable>& commandTable,
+                                        std::string_view source, const std::string& path)
+{
+    Assembler assembler;
+    if (commandTable) {
+        assembler.setCommandTable(commandTable);
+    }
+    assembler.setLineRecordsEnabled(options.lineRecords);
+
+    // Source line numbers for the listing, its cross-reference and the L records
+    std::vector<size_t> lineNumbers;
+    bool numbered = options.listing || options.lineRecords;
+    std::vector<std::vector<std::string>> sourceLines = Parser::parseCode(source, numbered ? &lineNumbers : nullptr);
+    if (numbered) {
+        assembler.setLineNumbers(lineNumbers);
+    }
+
+    if (options.onePass) {
+        return assembler.assemble(sourceLines, options.addressingMode);
+    }
+
+    // Same steps as the first and second pass buttons of the UI
+    std::vector<std::string> firstPassResult = assembler.firstPass(sourceLines, options.addressingMode);
+
+    std::string firstPassText;
+    for (const auto& line : firstPassResult) {
+        firstPassText += line + "\n";
+    }
+
+    assembler.clearTN();
+    if (!options.listing) {
+        return assembler.secondPass(Parser::parseCode(firstPassText));
+    }
+
+    // Written line by line during the second pass
+    std::ofstream listingFile(path + ".lst", std::ios::binary);
+    ListingWriter listing(listingFile, source, lineNumbers);
+    assembler.setListing(&listing);
+    std::vector<std::string> records = assembler.secondPass(Parser::parseCode(firstPassText));
+    if (!listingFile.flush()) {
+        throw AssemblerException("Не удалось записать файл: " + path + ".lst");
+    }
+    return records;
+}
+
+std::vector<std::string> assembleFile(const Options& options, const std::shared_ptr<const CommandTable>& commandTable, const std::string& path)
+{
+    MappedFile file(path);
+    return assembleSource(options, commandTable, file.view(), path);
+}
+
+void writeObjectCode(const std::vector<std::string>& records, const std::string& path)
+{
+    std::string objectText;
+    for (const auto& record : records) {
+        objectText += record + "\n";
+    }
+
+    if (path == "-") {
+        std::fwrite(objectText.data(), 1, objectText.size(), stdout);
+        return;
+    }
+
+    std::ofstream output(path, std::ios::binary);
+    output.write(objectText.data(), static_cast<std::streamsize>(objectText.size()));
+    if (!output) {
+        throw AssemblerException("Не удалось записать файл: " + path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // The table is parsed and validated once for all sources
+    std::shared_ptr<const CommandTable> commandTable;
+    if (!options.commandsPath.empty()) {
+        try {
+            MappedFile commandsFile(options.commandsPath);
+            commandTable = CommandTable::fromText(std::string(commandsFile.view()));
+        } catch (const std::exception& e) {
+            std::cerr << options.commandsPath << ": Ошибка: " << e.what() << "\n";
+            return 2;
+        }
+    }
+
+    // Every source is assembled even if an earlier one fails
+    int failed = 0;
+    for (const auto& path : options.sources) {
+        try {
+            std::vector<std::string> records = assembleFile(options, commandTable, path);
+            writeObjectCode(records, options.outputPath.empty() ? path + ".obj" : options.outputPath);
+        } catch (const std::exception& e) {
+            std::cerr << path << ": Ошибка: " << e.what() << "\n";
+            ++failed;
+        }
+    }
+
+    return failed == 0 ? 0 : 1;
+}
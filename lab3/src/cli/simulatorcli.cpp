@@ -0,0 +1,138 @@
+#include "io/mappedfile.h"
+#include "simulator/batchrunner.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Batch simulation: runs every program of the given directories and files on
+// worker threads and prints a report with the digests and MIPS of each one.
+
+namespace {
+
+struct Options
+{
+    BatchOptions batch;
+    std::string commandsPath;
+    std::string outputPath;
+    std::vector<std::string> inputs;
+};
+
+void printUsage()
+{
+    std::cerr <<
+        "Использование: SimulatorCli [параметры] <каталог или файл>...\n"
+        "  -l, --limit <число>                   лимит команд на программу (по умолчанию 100000000)\n"
+        "  -m, --mode <Straight|Relative|Mixed>  режим адресации исходников (по умолчанию Straight)\n"
+        "  -c, --commands <файл>                 таблица команд: имя, код и длина в hex\n"
+        "  -a, --address <hex>                   адрес загрузки (по умолчанию из H-записи)\n"
+        "  -o, --output <файл>                   файл отчёта (по умолчанию stdout)\n"
+        "      --jit                             машинный код для часто выполняемых блоков\n"
+        "      --profile                         профиль каждой программы в <файл>.prof\n"
+        "Файлы .obj выполняются как объектный код, остальные ассемблируются, если рядом нет свежего <файл>.obj.\n"
+        "Из каталога берутся только файлы .asm, .s и .obj\n";
+}
+
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if ((argument == "-l" || argument == "--limit") && hasValue) {
+                options.batch.maxInstructions = std::stoull(argv[++i]);
+            } else if ((argument == "-m" || argument == "--mode") && hasValue) {
+                std::string mode = argv[++i];
+                if (mode != "Straight" && mode != "Relative" && mode != "Mixed") {
+                    return false;
+                }
+                options.batch.addressingMode = addressingModeFromName(mode);
+            } else if ((argument == "-c" || argument == "--commands") && hasValue) {
+                options.commandsPath = argv[++i];
+            } else if ((argument == "-a" || argument == "--address") && hasValue) {
+                options.batch.loadAddress = std::stoi(argv[++i], nullptr, 16);
+            } else if ((argument == "-o" || argument == "--output") && hasValue) {
+                options.outputPath = argv[++i];
+            } else if (argument == "--jit") {
+                options.batch.jit = true;
+            } else if (argument == "--profile") {
+                options.batch.profile = true;
+            } else if (!argument.empty() && argument[0] == '-') {
+                return false;
+            } else {
+                options.inputs.push_back(argument);
+            }
+        }
+    } catch (const std::exception&) {
+        return false; // A number that does not parse
+    }
+
+    return !options.inputs.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<std::string> paths;
+    try {
+        if (!options.commandsPath.empty()) {
+            MappedFile commandsFile(options.commandsPath);
+            options.batch.commandTable = CommandTable::fromText(std::string(commandsFile.view()));
+        }
+        for (const auto& input : options.inputs) {
+            if (std::filesystem::is_directory(input)) {
+                std::vector<std::string> programs = BatchRunner::listPrograms(input);
+                paths.insert(paths.end(), programs.begin(), programs.end());
+            } else {
+                paths.push_back(input);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n";
+        return 2;
+    }
+
+    BatchRunner runner(options.batch);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runner.run(paths);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    for (const auto& result : results) {
+        if (result.status == BatchResult::ERROR || result.status == BatchResult::FAULT) {
+            ++failed;
+        }
+        if (options.batch.profile && result.status != BatchResult::ERROR) {
+            std::ofstream profile(result.path + ".prof", std::ios::binary);
+            profile.write(result.profile.data(), static_cast<std::streamsize>(result.profile.size()));
+            if (!profile) {
+                std::cerr << "Не удалось записать файл: " << result.path << ".prof\n";
+                return 2;
+            }
+        }
+    }
+
+    std::string report = BatchRunner::formatReport(results, seconds);
+    if (options.outputPath.empty()) {
+        std::fwrite(report.data(), 1, report.size(), stdout);
+    } else {
+        std::ofstream output(options.outputPath, std::ios::binary);
+        output.write(report.data(), static_cast<std::streamsize>(report.size()));
+        if (!output) {
+            std::cerr << "Не удалось записать файл: " << options.outputPath << "\n";
+            return 2;
+        }
+    }
+
+    // Programs that could not be loaded or hit an illegal command fail the batch
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+#include "exceptions/simulatorexception.h"
+
+SimulatorException::SimulatorException()
+    : std::runtime_error("Simulator error")
+{
+}
+
+SimulatorException::SimulatorException(const std::string& message)
+    : std::runtime_error(message)
+{
+}
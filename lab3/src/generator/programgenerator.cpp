@@ -0,0 +1,281 @@
+#include "generator/programgenerator.h"
+#include <algorithm>
+
+namespace {
+
+// Line kinds of the plan
+enum LineKind {
+    KIND_LABEL_COMMAND = 0,  // JMP/LOADR1/LOADR2/SAVER1 with a label operand
+    KIND_NUMBER_COMMAND,     // JMP/LOADR1/LOADR2/SAVER1 with a numeric operand
+    KIND_REGISTERS,          // ADD R1 R2
+    KIND_BYTE_COMMAND,       // INT 200
+    KIND_WORD,
+    KIND_BYTE,
+    KIND_RESB,
+    KIND_RESW
+};
+
+const char* const LABEL_COMMANDS[] = { "JMP", "LOADR1", "LOADR2", "SAVER1" };
+const char* const BYTE_COMMANDS[] = { "ADD", "INT" };
+
+const int MAX_ADDRESS = 16777215; // 2^24 - 1
+const int MAX_LINE_LENGTH = 255;  // Longest line the plan can produce (RESB 255)
+
+std::string pad(const std::string& text, std::size_t width)
+{
+    std::string result = text;
+    do {
+        result += ' ';
+    } while (result.length() < width);
+    return result;
+}
+
+} // namespace
+
+ProgramGenerator::ProgramGenerator(const GeneratorOptions& options)
+    : options_(options), state_(options.seed), nextLabel_(0)
+{
+}
+
+std::string ProgramGenerator::getAddressingMode() const
+{
+    if (options_.relativeRatio <= 0.0) return "Straight";
+    if (options_.relativeRatio >= 1.0) return "Relative";
+    return "Mixed";
+}
+
+std::string ProgramGenerator::defaultCommandsText()
+{
+    return "JMP 1 4\n"
+           "LOADR1 2 4\n"
+           "LOADR2 3 4\n"
+           "ADD 4 2\n"
+           "SAVER1 5 4\n"
+           "INT 6 2\n";
+}
+
+std::uint64_t ProgramGenerator::next()
+{
+    // splitmix64: same sequence on every platform and standard library
+    std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+std::size_t ProgramGenerator::nextIndex(std::size_t bound)
+{
+    return static_cast<std::size_t>(next() % bound);
+}
+
+int ProgramGenerator::nextInt(int min, int max)
+{
+    return min + static_cast<int>(next() % static_cast<std::uint64_t>(max - min + 1));
+}
+
+bool ProgramGenerator::chance(double ratio)
+{
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) < ratio;
+}
+
+std::string ProgramGenerator::labelName(int index)
+{
+    return "L" + std::to_string(index);
+}
+
+std::string ProgramGenerator::labelOperand(const std::string& name)
+{
+    return chance(options_.relativeRatio) ? "[" + name + "]" : name;
+}
+
+std::string ProgramGenerator::cString(int length)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 !?.,:-+*/";
+    std::string result = "C\"";
+    for (int i = 0; i < length; ++i) {
+        result += alphabet[nextIndex(sizeof(alphabet) - 1)];
+    }
+    return result + "\"";
+}
+
+std::string ProgramGenerator::xString(int bytes)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    std::string result = "X\"";
+    for (int i = 0; i < bytes * 2; ++i) {
+        result += digits[nextIndex(16)];
+    }
+    return result + "\"";
+}
+
+std::string ProgramGenerator::generate()
+{
+    state_ = options_.seed;
+    nextLabel_ = 0;
+
+    const std::size_t sectionCount = options_.csectCount + 1;
+    const int dataWeight = std::max(0, options_.byteWeight) + std::max(0, options_.wordWeight)
+                         + std::max(0, options_.resbWeight) + std::max(0, options_.reswWeight);
+
+    // Plan every section first so EXTREF can name EXTDEF symbols of the other sections
+    std::vector<std::vector<PlannedLine>> plans(sectionCount);
+    std::vector<std::vector<int>> labels(sectionCount);       // Global label numbers in line order
+    std::vector<std::vector<std::size_t>> labelLines(sectionCount);
+    std::vector<std::vector<int>> extdefs(sectionCount);
+    long long totalLength = 0;
+
+    for (std::size_t s = 0; s < sectionCount; ++s) {
+        plans[s].reserve(options_.lineCount);
+        for (std::size_t i = 0; i < options_.lineCount; ++i) {
+            PlannedLine line = { KIND_LABEL_COMMAND, -1, 4 };
+
+            // Shrink reservations once the program gets close to the end of memory
+            bool nearLimit = totalLength + MAX_LINE_LENGTH > MAX_ADDRESS;
+
+            if (dataWeight > 0 && chance(options_.dataRatio)) {
+                int pick = nextInt(0, dataWeight - 1);
+                if ((pick -= std::max(0, options_.byteWeight)) < 0) {
+                    line.kind = KIND_BYTE;
+                } else if ((pick -= std::max(0, options_.wordWeight)) < 0) {
+                    line.kind = KIND_WORD;
+                } else if ((pick -= std::max(0, options_.resbWeight)) < 0) {
+                    line.kind = KIND_RESB;
+                } else {
+                    line.kind = KIND_RESW;
+                }
+
+                switch (line.kind) {
+                case KIND_WORD: line.length = 3; break;
+                case KIND_BYTE: line.length = nearLimit ? 1 : nextInt(1, 16); break;
+                case KIND_RESB: line.length = nearLimit ? 1 : nextInt(1, 255); break;
+                default: line.length = (nearLimit ? 1 : nextInt(1, 85)) * 3; break;
+                }
+            } else {
+                int pick = nextInt(0, 9);
+                if (pick < 7) {
+                    line.kind = KIND_LABEL_COMMAND;
+                } else if (pick == 7) {
+                    line.kind = KIND_NUMBER_COMMAND;
+                } else if (pick == 8) {
+                    line.kind = KIND_REGISTERS;
+                    line.length = 2;
+                } else {
+                    line.kind = KIND_BYTE_COMMAND;
+                    line.length = 2;
+                }
+            }
+
+            if (totalLength + line.length > MAX_ADDRESS) break;
+            totalLength += line.length;
+
+            if (chance(options_.labelDensity)) {
+                line.label = static_cast<int>(labels[s].size());
+                labels[s].push_back(nextLabel_++);
+                labelLines[s].push_back(i);
+            }
+
+            plans[s].push_back(line);
+        }
+
+        std::size_t extdefCount = std::min(options_.extdefCount, labels[s].size());
+        for (std::size_t i = 0; i < extdefCount; ++i) {
+            extdefs[s].push_back(labels[s][i * labels[s].size() / extdefCount]);
+        }
+    }
+
+    std::string source;
+    source.reserve(sectionCount * options_.lineCount * 24 + 64);
+
+    for (std::size_t s = 0; s < sectionCount; ++s) {
+        if (s == 0) {
+            source += pad("PROG", 8) + pad("START", 8) + "0\n";
+        } else {
+            source += pad("SECT" + std::to_string(s), 8) + "CSECT\n";
+        }
+
+        for (int name : extdefs[s]) {
+            source += pad("", 8) + pad("EXTDEF", 8) + labelName(name) + "\n";
+        }
+
+        // External references come from the EXTDEF lists of the other sections
+        std::vector<int> extrefs;
+        if (sectionCount > 1) {
+            for (std::size_t i = 0; i < options_.extrefCount; ++i) {
+                const std::vector<int>& names = extdefs[(s + 1 + i % (sectionCount - 1)) % sectionCount];
+                std::size_t round = i / (sectionCount - 1);
+                if (round < names.size()) {
+                    extrefs.push_back(names[round]);
+                }
+            }
+        }
+        for (int name : extrefs) {
+            source += pad("", 8) + pad("EXTREF", 8) + labelName(name) + "\n";
+        }
+
+        bool relativeOnly = options_.relativeRatio >= 1.0;
+
+        for (std::size_t i = 0; i < plans[s].size(); ++i) {
+            const PlannedLine& line = plans[s][i];
+            std::string text = pad(line.label >= 0 ? labelName(labels[s][line.label]) : "", 8);
+
+            switch (line.kind) {
+            case KIND_LABEL_COMMAND: {
+                std::string command = LABEL_COMMANDS[nextIndex(4)];
+                const std::vector<std::size_t>& lines = labelLines[s];
+                // First label defined after this line
+                std::size_t split = std::upper_bound(lines.begin(), lines.end(), i) - lines.begin();
+
+                std::string operand;
+                if (!relativeOnly && !extrefs.empty() && chance(0.1)) {
+                    operand = labelName(extrefs[nextIndex(extrefs.size())]);
+                } else if (!lines.empty()) {
+                    bool forward = chance(options_.forwardReferenceRatio);
+                    if (split == lines.size()) forward = false;
+                    if (split == 0) forward = true;
+
+                    std::size_t index = forward ? split + nextIndex(lines.size() - split) : nextIndex(split);
+                    operand = labelOperand(labelName(labels[s][index]));
+                } else {
+                    operand = std::to_string(nextInt(0, MAX_ADDRESS));
+                }
+                text += pad(command, 8) + operand;
+                break;
+            }
+            case KIND_NUMBER_COMMAND:
+                text += pad(LABEL_COMMANDS[nextIndex(4)], 8) + std::to_string(nextInt(0, MAX_ADDRESS));
+                break;
+            case KIND_REGISTERS:
+                text += pad("ADD", 8) + "R" + std::to_string(nextInt(1, 16)) + " R" + std::to_string(nextInt(1, 16));
+                break;
+            case KIND_BYTE_COMMAND:
+                text += pad(BYTE_COMMANDS[nextIndex(2)], 8) + std::to_string(nextInt(0, 255));
+                break;
+            case KIND_WORD:
+                text += pad("WORD", 8) + std::to_string(nextInt(1, MAX_ADDRESS));
+                break;
+            case KIND_BYTE: {
+                int form = line.length == 1 ? nextInt(0, 2) : nextInt(1, 2);
+                if (form == 0) {
+                    text += pad("BYTE", 8) + std::to_string(nextInt(0, 255));
+                } else if (form == 1) {
+                    text += pad("BYTE", 8) + cString(line.length);
+                } else {
+                    text += pad("BYTE", 8) + xString(line.length);
+                }
+                break;
+            }
+            case KIND_RESB:
+                text += pad("RESB", 8) + std::to_string(line.length);
+                break;
+            case KIND_RESW:
+                text += pad("RESW", 8) + std::to_string(line.length / 3);
+                break;
+            }
+
+            source += text + "\n";
+        }
+    }
+
+    source += pad("", 8) + "END\n";
+    return source;
+}
@@ -0,0 +1,96 @@
+#include "io/mappedfile.h"
+#include "exceptions/assemblerexception.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+    : data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw AssemblerException("Не удалось открыть файл: " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize)) {
+        CloseHandle(file_);
+        throw AssemblerException("Не удалось прочитать файл: " + path);
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    // An empty file can't be mapped and has nothing to read
+    if (size_ == 0) return;
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw AssemblerException("Не удалось отобразить файл в память: " + path);
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw AssemblerException("Не удалось отобразить файл в память: " + path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : data_(nullptr), size_(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw AssemblerException("Не удалось открыть файл: " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        throw AssemblerException("Не удалось прочитать файл: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    // An empty file can't be mapped and has nothing to read
+    if (size_ == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file open
+
+    if (address == MAP_FAILED) {
+        throw AssemblerException("Не удалось отобразить файл в память: " + path);
+    }
+
+    // The source is read once from start to end
+    ::madvise(address, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(address);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "parser/charscanner.h"
+#include "utils/cpufeatures.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHARSCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(CHARSCANNER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CHARSCANNER_AVX2 1
+#define CHARSCANNER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+#ifdef CHARSCANNER_X86
+
+// SSE2 is part of x86-64, so this kernel needs no check
+CharScanner::BlockMasks scanBlockSse2(const char* block)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+
+    CharScanner::BlockMasks masks = { 0, 0, 0 };
+    for (int i = 0; i < 4; ++i) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+
+        // '\t' ... '\r' are the bytes with (c - '\t') <= 4 unsigned; '\n' is one of them
+        __m128i fromTab = _mm_sub_epi8(bytes, tab);
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(fromTab, four), fromTab);
+        __m128i newlines = _mm_cmpeq_epi8(bytes, newline);
+        __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_andnot_si128(newlines, control));
+
+        int shift = i * 16;
+        masks.newlines |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(newlines))) << shift;
+        masks.spaces |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(spaces))) << shift;
+        masks.quotes |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << shift;
+    }
+    return masks;
+}
+
+#endif
+
+#ifdef CHARSCANNER_AVX2
+
+CHARSCANNER_TARGET_AVX2
+CharScanner::BlockMasks scanBlockAvx2(const char* block)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+
+    CharScanner::BlockMasks masks = { 0, 0, 0 };
+    for (int i = 0; i < 2; ++i) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+
+        __m256i fromTab = _mm256_sub_epi8(bytes, tab);
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(fromTab, four), fromTab);
+        __m256i newlines = _mm256_cmpeq_epi8(bytes, newline);
+        __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), _mm256_andnot_si256(newlines, control));
+
+        int shift = i * 32;
+        masks.newlines |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(newlines))) << shift;
+        masks.spaces |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(spaces))) << shift;
+        masks.quotes |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, quote)))) << shift;
+    }
+    return masks;
+}
+
+#endif
+
+CharScanner::Kernel& selectedKernel()
+{
+    static CharScanner::Kernel kernel = CharScanner::availableKernels().back().kernel;
+    return kernel;
+}
+
+} // namespace
+
+CharScanner::BlockMasks CharScanner::scanBlockScalar(const char* block)
+{
+    BlockMasks masks = { 0, 0, 0 };
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        char c = block[i];
+        uint64_t bit = uint64_t(1) << i;
+        if (c == '\n') {
+            masks.newlines |= bit;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+            masks.spaces |= bit;
+        } else if (c == '"') {
+            masks.quotes |= bit;
+        }
+    }
+    return masks;
+}
+
+CharScanner::Kernel CharScanner::kernel()
+{
+    return selectedKernel();
+}
+
+std::vector<CharScanner::KernelInfo> CharScanner::availableKernels()
+{
+    std::vector<KernelInfo> kernels{ { "scalar", &CharScanner::scanBlockScalar } };
+#ifdef CHARSCANNER_X86
+    kernels.push_back({ "sse2", &scanBlockSse2 });
+#endif
+#ifdef CHARSCANNER_AVX2
+    if (cpuHasAvx2()) {
+        kernels.push_back({ "avx2", &scanBlockAvx2 });
+    }
+#endif
+    return kernels;
+}
+
+void CharScanner::setKernel(Kernel kernel)
+{
+    selectedKernel() = kernel;
+}
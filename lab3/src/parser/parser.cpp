@@ -1,46 +1,217 @@
 #include "parser/parser.h"
-#include <regex>
+#include "parser/charscanner.h"
+#include "utils/parallel.h"
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <iterator>
 
-std::vector<std::vector<std::string>> Parser::parseCode(const std::string& input)
+namespace {
+
+// Walks the input block by block and finds the next character of a class
+class BlockCursor
 {
-    std::vector<std::vector<std::string>> result;
-    std::istringstream stream(input);
-    std::string line;
+public:
+    enum CharClass { NOT_SPACE, SEPARATOR, NEWLINE, QUOTE };
 
-    while (std::getline(stream, line)) {
-        // Replace tabs with spaces
-        std::replace(line.begin(), line.end(), '\t', ' ');
+    BlockCursor(std::string_view input, CharScanner::Kernel kernel)
+        : input_(input), kernel_(kernel), blockStart_(std::string_view::npos), masks_{ 0, 0, 0 }
+    {
+    }
 
-        // Tokenize the line
-        std::vector<std::string> tokens = tokenizeLine(line);
+    // Position of the first character of the class at or after from, or the input size
+    size_t next(CharClass charClass, size_t from)
+    {
+        size_t blockStart = from - from % CharScanner::BLOCK_SIZE;
+        if (blockStart >= input_.size()) {
+            return input_.size();
+        }
+        load(blockStart);
 
-        // Filter out empty tokens
-        tokens.erase(std::remove_if(tokens.begin(), tokens.end(),
-                                    [](const std::string& token) { return token.empty(); }), tokens.end());
+        uint64_t bits = mask(charClass) & (~uint64_t(0) << (from - blockStart));
+        while (bits == 0) {
+            blockStart += CharScanner::BLOCK_SIZE;
+            if (blockStart >= input_.size()) {
+                return input_.size();
+            }
+            load(blockStart);
+            bits = mask(charClass);
+        }
 
-        if (!tokens.empty()) {
-            result.push_back(tokens);
+        return std::min(blockStart + countTrailingZeros(bits), input_.size());
+    }
+
+private:
+    std::string_view input_;
+    CharScanner::Kernel kernel_;
+    size_t blockStart_;
+    CharScanner::BlockMasks masks_;
+
+    void load(size_t blockStart)
+    {
+        if (blockStart == blockStart_) {
+            return;
+        }
+        blockStart_ = blockStart;
+
+        if (blockStart + CharScanner::BLOCK_SIZE <= input_.size()) {
+            masks_ = kernel_(input_.data() + blockStart);
+            return;
         }
+
+        // The last block is padded with '\0', which is in no class but NOT_SPACE;
+        // next() cuts positions past the end to the input size
+        char block[CharScanner::BLOCK_SIZE] = {};
+        std::copy(input_.begin() + blockStart, input_.end(), block);
+        masks_ = kernel_(block);
+    }
+
+    uint64_t mask(CharClass charClass) const
+    {
+        switch (charClass) {
+        case NOT_SPACE:
+            return ~masks_.spaces;
+        case SEPARATOR:
+            return masks_.spaces | masks_.newlines;
+        case NEWLINE:
+            return masks_.newlines;
+        case QUOTE:
+            return masks_.quotes;
+        }
+        return 0;
+    }
+
+    static size_t countTrailingZeros(uint64_t bits)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+        size_t count = 0;
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            ++count;
+        }
+        return count;
+#endif
+    }
+};
+
+} // namespace
+
+std::vector<std::vector<std::string>> Parser::parseCode(std::string_view input, std::vector<size_t>* lineNumbers)
+{
+    std::vector<std::vector<std::string>> result;
+    if (lineNumbers != nullptr) {
+        lineNumbers->clear();
+    }
+
+    if (input.size() < PARALLEL_MIN_BYTES || workerCount() < 2) {
+        parseLines(input, 1, result, lineNumbers);
+        return result;
+    }
+
+    // Chunks end right after a '\n', so no line is split; a few per thread even out their sizes
+    size_t chunkCount = workerCount() * 4;
+    std::vector<size_t> bounds{ 0 };
+    for (size_t i = 1; i < chunkCount; ++i) {
+        size_t bound = std::max(bounds.back(), input.size() * i / chunkCount);
+        size_t lineEnd = input.find('\n', bound);
+        if (lineEnd == std::string_view::npos) {
+            break;
+        }
+        if (lineEnd + 1 > bounds.back()) {
+            bounds.push_back(lineEnd + 1);
+        }
+    }
+    bounds.push_back(input.size());
+
+    // Every chunk numbers its lines from zero, then the numbers are shifted by the lines before it
+    size_t count = bounds.size() - 1;
+    std::vector<std::vector<std::vector<std::string>>> chunkLines(count);
+    std::vector<std::vector<size_t>> chunkNumbers(count);
+    std::vector<size_t> chunkLineCounts(count);
+
+    parallelFor(count, [&](size_t i) {
+        std::string_view chunk = input.substr(bounds[i], bounds[i + 1] - bounds[i]);
+        chunkLineCounts[i] = parseLines(chunk, 0, chunkLines[i], lineNumbers != nullptr ? &chunkNumbers[i] : nullptr);
+    });
+
+    size_t total = 0;
+    for (const auto& lines : chunkLines) {
+        total += lines.size();
+    }
+    result.reserve(total);
+    if (lineNumbers != nullptr) {
+        lineNumbers->reserve(total);
+    }
+
+    // Token vectors are moved, their strings are not copied
+    size_t firstLine = 1;
+    for (size_t i = 0; i < count; ++i) {
+        std::move(chunkLines[i].begin(), chunkLines[i].end(), std::back_inserter(result));
+        if (lineNumbers != nullptr) {
+            for (size_t number : chunkNumbers[i]) {
+                lineNumbers->push_back(firstLine + number);
+            }
+        }
+        firstLine += chunkLineCounts[i];
     }
 
     return result;
 }
 
-std::vector<std::string> Parser::tokenizeLine(const std::string& line)
+size_t Parser::parseLines(std::string_view input, size_t firstLine, std::vector<std::vector<std::string>>& lines, std::vector<size_t>* lineNumbers)
 {
+    // Lines end at '\n' like std::getline; '\r' of CRLF is whitespace. Token boundaries
+    // come from the masks of CharScanner instead of a per-character loop.
+    BlockCursor cursor(input, CharScanner::kernel());
     std::vector<std::string> tokens;
-    std::regex pattern(R"((?:[CX]"[^"]*(?:"[^"]*)*"|\S+))");
-    std::sregex_iterator iter(line.begin(), line.end(), pattern);
-    std::sregex_iterator end;
+    size_t lineNumber = firstLine;
+    size_t pos = 0;
+
+    while (true) {
+        size_t start = cursor.next(BlockCursor::NOT_SPACE, pos);
+        if (start == input.size() || input[start] == '\n') {
+            if (!tokens.empty()) {
+                // One allocation of the exact size per line; the scratch vector keeps its capacity
+                lines.emplace_back(std::make_move_iterator(tokens.begin()), std::make_move_iterator(tokens.end()));
+                tokens.clear();
+                if (lineNumbers != nullptr) {
+                    lineNumbers->push_back(lineNumber);
+                }
+            }
+            if (start == input.size()) {
+                break;
+            }
+            ++lineNumber;
+            pos = start + 1;
+            continue;
+        }
+
+        // Same tokens as the pattern (?:[CX]"[^"]*(?:"[^"]*)*"|\S+) over the line with tabs
+        // replaced by spaces: a C"..." or X"..." literal runs to the last quote of the line
+        size_t end = 0;
+        if ((input[start] == 'C' || input[start] == 'X') && start + 1 < input.size() && input[start + 1] == '"') {
+            size_t lineEnd = cursor.next(BlockCursor::NEWLINE, start);
+            for (size_t quote = cursor.next(BlockCursor::QUOTE, start + 2); quote < lineEnd;
+                 quote = cursor.next(BlockCursor::QUOTE, quote + 1)) {
+                end = quote + 1;
+            }
+        }
 
-    for (; iter != end; ++iter) {
-        tokens.push_back(iter->str());
+        if (end == 0) {
+            end = cursor.next(BlockCursor::SEPARATOR, start + 1);
+            tokens.emplace_back(input.substr(start, end - start));
+        } else {
+            std::string token(input.substr(start, end - start));
+            std::replace(token.begin(), token.end(), '\t', ' ');
+            tokens.push_back(std::move(token));
+        }
+        pos = end;
     }
 
-    return tokens;
+    // Number of source lines read; a last line without '\n' counts too
+    return lineNumber - firstLine + (!input.empty() && input.back() != '\n' ? 1 : 0);
 }
 
 std::vector<Command> Parser::textToCommands(const std::string& text)
@@ -84,9 +255,20 @@ std::vector<Command> Parser::textToCommands(const std::string& text)
     return commands;
 }
 
+int Parser::registerNumber(const std::string& token)
+{
+    // R1-R9 or R10-R16, without leading zeros
+    if (token.length() == 2 && token[0] == 'R' && token[1] >= '1' && token[1] <= '9') {
+        return token[1] - '0';
+    }
+    if (token.length() == 3 && token[0] == 'R' && token[1] == '1' && token[2] >= '0' && token[2] <= '6') {
+        return 10 + (token[2] - '0');
+    }
+    return 0;
+}
+
 bool Parser::isRegister(const std::string& token) {
-    std::regex regPattern(R"(^R(?:[1-9]|1[0-6])$)");
-    return std::regex_match(token, regPattern);
+    return registerNumber(token) != 0;
 }
 
 CodeLine Parser::parseCodeLine(const std::vector<std::string>& line)
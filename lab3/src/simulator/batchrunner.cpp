@@ -0,0 +1,212 @@
+#include "simulator/batchrunner.h"
+#include "assembler/assembler.h"
+#include "io/mappedfile.h"
+#include "parser/parser.h"
+#include "simulator/profiler.h"
+#include "utils/parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <map>
+
+namespace {
+
+const char* const OBJECT_SUFFIX = ".obj";
+const char* const SOURCE_SUFFIXES[] = { ".asm", ".s" }; // Other files of a directory are not programs
+
+bool hasSuffix(const std::string& path, const char* suffix)
+{
+    size_t length = std::char_traits<char>::length(suffix);
+    return path.size() >= length && path.compare(path.size() - length, length, suffix) == 0;
+}
+
+bool isObjectPath(const std::string& path)
+{
+    return hasSuffix(path, OBJECT_SUFFIX);
+}
+
+bool isSourcePath(const std::string& path)
+{
+    return std::any_of(std::begin(SOURCE_SUFFIXES), std::end(SOURCE_SUFFIXES),
+                       [&path](const char* suffix) { return hasSuffix(path, suffix); });
+}
+
+uint64_t registerDigest(const Simulator& simulator)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mixWord = [&hash](uint32_t word) {
+        for (int shift = 16; shift >= 0; shift -= 8) {
+            hash = (hash ^ ((word >> shift) & 0xFF)) * 1099511628211ull;
+        }
+    };
+
+    for (int i = 0; i < Simulator::REGISTER_COUNT; ++i) {
+        mixWord(simulator.getRegister(i));
+    }
+    mixWord(simulator.getInstructionPointer());
+    return hash;
+}
+
+const char* statusName(BatchResult::Status status)
+{
+    switch (status) {
+    case BatchResult::HALTED: return "HALTED";
+    case BatchResult::LIMIT_REACHED: return "LIMIT";
+    case BatchResult::FAULT: return "FAULT";
+    case BatchResult::ERROR: return "ERROR";
+    }
+    return "";
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(const BatchOptions& options)
+    : options_(options),
+      commandTable_(options.commandTable ? options.commandTable : Assembler().getCommandTable()),
+      semantics_(*commandTable_)
+{
+}
+
+std::vector<std::string> BatchRunner::listPrograms(const std::string& directory)
+{
+    namespace fs = std::filesystem;
+
+    std::map<std::string, fs::file_time_type> files; // Path -> modification time, in name order
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && !name.empty() && name[0] != '.') {
+            files[entry.path().string()] = entry.last_write_time();
+        }
+    }
+
+    std::vector<std::string> programs;
+    for (const auto& [path, time] : files) {
+        if (isObjectPath(path)) {
+            // Stale if the source was changed after it was assembled
+            auto source = files.find(path.substr(0, path.size() - std::char_traits<char>::length(OBJECT_SUFFIX)));
+            if (source != files.end() && source->second > time) continue;
+        } else if (isSourcePath(path)) {
+            auto object = files.find(path + OBJECT_SUFFIX);
+            if (object != files.end() && object->second >= time) continue;
+        } else {
+            continue; // .prof, .lst and other output
+        }
+        programs.push_back(path);
+    }
+    return programs;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<std::string>& paths) const
+{
+    std::vector<BatchResult> results(paths.size());
+    parallelFor(paths.size(), [&](size_t i) {
+        results[i] = runProgram(paths[i]);
+    });
+    return results;
+}
+
+ObjectProgram BatchRunner::readProgram(const std::string& path, std::string& source) const
+{
+    MappedFile file(path);
+    if (isObjectPath(path)) {
+        ObjectProgram program = ObjectProgram::fromText(file.view());
+        bool hasLines = std::any_of(program.getSections().begin(), program.getSections().end(),
+                                    [](const ObjectProgram::Section& section) { return !section.lines.empty(); });
+
+        // The L records number the lines of the source the object was assembled from
+        std::string sourcePath = path.substr(0, path.size() - std::char_traits<char>::length(OBJECT_SUFFIX));
+        if (options_.profile && hasLines && std::filesystem::is_regular_file(sourcePath)) {
+            MappedFile sourceFile(sourcePath);
+            source = sourceFile.view();
+        }
+        return program;
+    }
+
+    Assembler assembler;
+    assembler.setCommandTable(commandTable_);
+    assembler.setLineRecordsEnabled(options_.profile);
+    std::vector<size_t> lineNumbers;
+    std::vector<std::vector<std::string>> lines = Parser::parseCode(file.view(), options_.profile ? &lineNumbers : nullptr);
+    assembler.setLineNumbers(std::move(lineNumbers));
+    ObjectProgram program = ObjectProgram::parse(assembler.assemble(lines, options_.addressingMode));
+    if (options_.profile) {
+        source = file.view();
+    }
+    return program;
+}
+
+BatchResult BatchRunner::runProgram(const std::string& path) const
+{
+    BatchResult result;
+    result.path = path;
+
+    Simulator simulator(semantics_);
+    simulator.setJitEnabled(options_.jit);
+    simulator.setProfilingEnabled(options_.profile);
+
+    std::string source;
+    try {
+        simulator.load(readProgram(path, source), options_.loadAddress);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::StopReason reason;
+    for (;;) {
+        reason = simulator.run(options_.maxInstructions - simulator.getInstructionCount());
+        if (reason != Simulator::INTERRUPTED) break;
+        ++result.interrupts;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    result.status = reason == Simulator::HALTED ? BatchResult::HALTED
+                  : reason == Simulator::LIMIT_REACHED ? BatchResult::LIMIT_REACHED
+                  : BatchResult::FAULT;
+    result.instructions = simulator.getInstructionCount();
+    result.registerDigest = registerDigest(simulator);
+    result.memoryDigest = simulator.getMemory().digest();
+
+    if (options_.profile) {
+        Profiler profiler(simulator.getProfile(), simulator.getProgram(), simulator.getProgram().lineTable);
+        if (!source.empty()) {
+            result.profile = profiler.annotatedListing(source) + "\n";
+        }
+        result.profile += profiler.flatProfile(source, *commandTable_);
+    }
+    return result;
+}
+
+std::string BatchRunner::formatReport(const std::vector<BatchResult>& results, double wallSeconds)
+{
+    std::string report = "# путь\tостанов\tкоманд\tпрерываний\tMIPS\tрегистры\tпамять\n";
+    char line[256];
+    size_t counts[BatchResult::ERROR + 1] = {};
+    uint64_t instructions = 0;
+
+    for (const auto& result : results) {
+        ++counts[result.status];
+        report += result.path;
+        report += '\t';
+        report += statusName(result.status);
+        if (result.status == BatchResult::ERROR) {
+            report += '\t' + result.error + '\n';
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "\t%llu\t%u\t%.1f\t%016llx\t%016llx\n",
+                      static_cast<unsigned long long>(result.instructions), result.interrupts, result.mips(),
+                      static_cast<unsigned long long>(result.registerDigest), static_cast<unsigned long long>(result.memoryDigest));
+        report += line;
+        instructions += result.instructions;
+    }
+
+    std::snprintf(line, sizeof(line), "Программ: %zu (HALTED %zu, LIMIT %zu, FAULT %zu, ERROR %zu), команд: %llu, %.3f с, %.1f MIPS\n",
+                  results.size(), counts[BatchResult::HALTED], counts[BatchResult::LIMIT_REACHED], counts[BatchResult::FAULT],
+                  counts[BatchResult::ERROR], static_cast<unsigned long long>(instructions), wallSeconds,
+                  wallSeconds > 0 ? instructions / wallSeconds / 1e6 : 0);
+    report += line;
+    return report;
+}
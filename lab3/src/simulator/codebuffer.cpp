@@ -0,0 +1,72 @@
+#include "simulator/codebuffer.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+CodeBuffer::CodeBuffer(size_t capacity)
+    : data_(nullptr), size_(0), capacity_(0)
+{
+#ifdef __linux__
+    void* mapping = mmap(nullptr, capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping != MAP_FAILED) {
+        data_ = static_cast<uint8_t*>(mapping);
+        capacity_ = capacity;
+    }
+#else
+    (void)capacity;
+#endif
+}
+
+CodeBuffer::~CodeBuffer()
+{
+#ifdef __linux__
+    if (data_ != nullptr) {
+        munmap(data_, capacity_);
+    }
+#endif
+}
+
+bool CodeBuffer::isSupported()
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CodeBuffer::beginWrite()
+{
+#ifdef __linux__
+    return data_ != nullptr && mprotect(data_, capacity_, PROT_READ | PROT_WRITE) == 0;
+#else
+    return false;
+#endif
+}
+
+void CodeBuffer::endWrite()
+{
+#ifdef __linux__
+    mprotect(data_, capacity_, PROT_READ | PROT_EXEC);
+    // x86 keeps instruction fetch coherent with stores; other targets would also need a cache flush here
+#endif
+}
+
+void CodeBuffer::emit32(uint32_t value)
+{
+    std::memcpy(data_ + size_, &value, sizeof(value));
+    size_ += sizeof(value);
+}
+
+void CodeBuffer::emit64(uint64_t value)
+{
+    std::memcpy(data_ + size_, &value, sizeof(value));
+    size_ += sizeof(value);
+}
+
+void CodeBuffer::patch32(size_t offset, uint32_t value)
+{
+    std::memcpy(data_ + offset, &value, sizeof(value));
+}
@@ -0,0 +1,293 @@
+#include "simulator/simulator.h"
+#include <initializer_list>
+
+// x86-64 code for hot basic blocks of the simulator.
+//
+// A compiled block is called as NativeBlock with the registers of run in rdi and
+// the instruction budget in *rsi. The entry loads the budget into rdx; the body
+// right after it subtracts the commands of the block and leaves with the block
+// address if the budget is short. Jumps to compiled blocks go straight to their
+// bodies, others return the address in eax and write the budget back. Only
+// scratch registers are used (eax, ecx, rdx, r8, r9), so no stack frame is needed.
+
+bool Simulator::isJitAvailable()
+{
+#ifdef SIMULATOR_JIT
+    return CodeBuffer::isSupported();
+#else
+    return false;
+#endif
+}
+
+void Simulator::setJitEnabled(bool enabled)
+{
+#ifdef SIMULATOR_JIT
+    if (enabled && !jitCode_) {
+        jitCode_.reset(new CodeBuffer(JIT_CODE_SIZE));
+    }
+    jitEnabled_ = enabled && jitCode_->isValid();
+    flushNative();
+#else
+    (void)enabled;
+#endif
+}
+
+void Simulator::flushNative()
+{
+    for (auto& block : blockAt_) {
+        if (block.native != NOT_COMPILABLE) {
+            block.native = NOT_COMPILED;
+            block.runs = 0;
+        }
+    }
+    if (jitCode_) {
+        jitCode_->clear();
+    }
+    compiledCount_ = 0;
+}
+
+#ifdef SIMULATOR_JIT
+
+namespace {
+
+const size_t ENTRY_SIZE = 3;        // mov rdx, [rsi] before the body
+const size_t MAX_OP_SIZE = 128;     // Bytes of one command with its guard stub
+const size_t MAX_BLOCK_EXTRA = 64;  // Budget check and exits
+
+// The few instruction forms the blocks use; register operands are fixed
+class X86Writer
+{
+public:
+    enum Condition : uint8_t { BELOW = 0x82, EQUAL = 0x84, NOT_EQUAL = 0x85 };
+
+    explicit X86Writer(CodeBuffer& code) : code_(code) {}
+
+    size_t position() const { return code_.size(); }
+
+    void loadBudget() { put({ 0x48, 0x8B, 0x16 }); }                                  // mov rdx, [rsi]
+    void subBudget(uint32_t count) { put({ 0x48, 0x81, 0xEA }); code_.emit32(count); } // sub rdx, imm32
+    void addBudget(uint32_t count) { put({ 0x48, 0x81, 0xC2 }); code_.emit32(count); } // add rdx, imm32
+
+    // Returns the address with the budget written back
+    void exit(uint32_t address, bool codeWritten)
+    {
+        code_.emit8(0xB8);                                       // mov eax, imm32
+        code_.emit32(address);
+        if (codeWritten) put({ 0x48, 0x0F, 0xBA, 0xE8, 0x20 });  // bts rax, 32
+        put({ 0x48, 0x89, 0x16, 0xC3 });                          // mov [rsi], rdx; ret
+    }
+
+    void loadRegister(int index) { put({ 0x8B, 0x47, displacement(index) }); }  // mov eax, [rdi + disp8]
+    void storeRegister(int index) { put({ 0x89, 0x47, displacement(index) }); } // mov [rdi + disp8], eax
+    void addRegister(int index) { put({ 0x03, 0x47, displacement(index) }); }   // add eax, [rdi + disp8]
+    void subRegister(int index) { put({ 0x2B, 0x47, displacement(index) }); }   // sub eax, [rdi + disp8]
+    void compareRegisterWithZero(int index) { put({ 0x83, 0x7F, displacement(index), 0x00 }); } // cmp dword [rdi + disp8], 0
+    void negate() { put({ 0xF7, 0xD8 }); }                                      // neg eax
+    void maskAddress() { code_.emit8(0x25); code_.emit32(Memory::ADDRESS_MASK); } // and eax, imm32
+
+    // eax = the big-endian word at bytes; 3 separate bytes, the 4th may be past the page
+    void loadWord(const uint8_t* bytes)
+    {
+        pointer(0xB8, bytes);                    // movabs r8, imm64
+        put({ 0x41, 0x0F, 0xB7, 0x00 });         // movzx eax, word [r8]
+        put({ 0x66, 0xC1, 0xC0, 0x08 });         // rol ax, 8
+        put({ 0xC1, 0xE0, 0x08 });               // shl eax, 8
+        put({ 0x41, 0x0F, 0xB6, 0x48, 0x02 });   // movzx ecx, byte [r8 + 2]
+        put({ 0x09, 0xC8 });                     // or eax, ecx
+    }
+
+    // Stores eax as a big-endian word at bytes; eax is clobbered. The parts match
+    // those of loadWord, so a load right after the store is forwarded from it.
+    void storeWord(uint8_t* bytes)
+    {
+        pointer(0xB8, bytes);                    // movabs r8, imm64
+        put({ 0x41, 0x88, 0x40, 0x02 });         // mov [r8 + 2], al
+        put({ 0xC1, 0xE8, 0x08 });               // shr eax, 8
+        put({ 0x66, 0xC1, 0xC0, 0x08 });         // rol ax, 8
+        put({ 0x66, 0x41, 0x89, 0x00 });         // mov [r8], ax
+    }
+
+    void loadFlags(const uint8_t* flags) { pointer(0xB9, flags); }              // movabs r9, imm64
+    void compareFlag(uint8_t offset) { put({ 0x41, 0x80, 0x79, offset, 0x00 }); } // cmp byte [r9 + disp8], 0
+
+    // Jumps with a 32-bit displacement; the returned position is fixed up by bind
+    size_t jump() { code_.emit8(0xE9); code_.emit32(0); return position() - 4; }
+    size_t jump(Condition condition) { put({ 0x0F, condition }); code_.emit32(0); return position() - 4; }
+
+    void bind(size_t site, size_t target)
+    {
+        code_.patch32(site, static_cast<uint32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(site + 4)));
+    }
+
+private:
+    static uint8_t displacement(int registerIndex) { return static_cast<uint8_t>(registerIndex * 4); }
+
+    void put(std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t byte : bytes) code_.emit8(byte);
+    }
+
+    void pointer(uint8_t opcode, const void* address)
+    {
+        put({ 0x49, opcode });
+        code_.emit64(reinterpret_cast<uint64_t>(address));
+    }
+
+    CodeBuffer& code_;
+};
+
+} // namespace
+
+Simulator::Block Simulator::compileBlock(uint32_t index)
+{
+    Block& block = blockAt_[index];
+    const Decoded* ops = &blockOps_[block.firstOp];
+
+    // Memory operands must be bound to pages; INT and HALT stop run, so such blocks stay interpreted
+    for (uint32_t i = 0; i <= block.count; ++i) {
+        switch (ops[i].handler) {
+        case NOP: case ADD_REGISTERS: case SUB_REGISTERS:
+        case LOAD_DIRECT: case ADD_MEMORY_DIRECT: case SUB_MEMORY_DIRECT: case STORE_DIRECT:
+        case JUMP: case JUMP_ZERO: case JUMP_NOT_ZERO: case BLOCK_END:
+            break;
+        case STORE:
+            if (ops[i].bytes != nullptr) break;
+            block.native = NOT_COMPILABLE;
+            return block;
+        default:
+            block.native = NOT_COMPILABLE;
+            return block;
+        }
+    }
+
+    size_t needed = block.count * MAX_OP_SIZE + MAX_BLOCK_EXTRA;
+    if (jitCode_->available() < needed) {
+        flushNative();
+    }
+    if (jitCode_->available() < needed || !jitCode_->beginWrite()) {
+        block.native = NOT_COMPILABLE;
+        return block;
+    }
+
+    X86Writer x(*jitCode_);
+    const uint32_t address = codeBegin_ + index;
+    const size_t entry = x.position();
+    x.loadBudget();
+    const size_t body = x.position();
+    x.subBudget(block.count);
+    const size_t shortBudget = x.jump(X86Writer::BELOW);
+
+    // Straight into a compiled block, otherwise back to run
+    auto jumpTo = [&](uint32_t target) {
+        uint32_t targetIndex = target - codeBegin_;
+        if (targetIndex == index) {
+            x.bind(x.jump(), body);
+        } else if (targetIndex < blockAt_.size() && blockAt_[targetIndex].native >= 0) {
+            x.bind(x.jump(), static_cast<size_t>(blockAt_[targetIndex].native) + ENTRY_SIZE);
+        } else {
+            x.exit(target, false);
+        }
+    };
+
+    struct Guard
+    {
+        size_t site;       // Jump to the stub
+        uint32_t executed; // Commands run up to the store
+        uint32_t next;
+    };
+    std::vector<Guard> guards;
+
+    for (uint32_t i = 0; i <= block.count; ++i) {
+        const Decoded& d = ops[i];
+        bool ended = false;
+        switch (d.handler) {
+        case LOAD_DIRECT:
+            x.loadWord(d.bytes);
+            x.storeRegister(d.first);
+            break;
+        case ADD_MEMORY_DIRECT:
+            x.loadWord(d.bytes);
+            x.addRegister(d.first);
+            x.maskAddress();
+            x.storeRegister(d.first);
+            break;
+        case SUB_MEMORY_DIRECT:
+            x.loadWord(d.bytes);
+            x.negate();
+            x.addRegister(d.first);
+            x.maskAddress();
+            x.storeRegister(d.first);
+            break;
+        case ADD_REGISTERS:
+            x.loadRegister(d.first);
+            x.addRegister(d.second);
+            x.maskAddress();
+            x.storeRegister(d.first);
+            break;
+        case SUB_REGISTERS:
+            x.loadRegister(d.first);
+            x.subRegister(d.second);
+            x.maskAddress();
+            x.storeRegister(d.first);
+            break;
+        case STORE_DIRECT:
+            x.loadRegister(d.first);
+            x.storeWord(d.bytes);
+            break;
+        case STORE: {
+            // The guard: leave after the store if it wrote into a block, as the interpreter does
+            x.loadRegister(d.first);
+            x.storeWord(d.bytes);
+            int64_t first = static_cast<int64_t>(d.operand) - codeBegin_;
+            int64_t begin = std::max<int64_t>(first, 0);
+            int64_t end = std::min<int64_t>(first + 3, static_cast<int64_t>(blockCovered_.size()));
+            if (begin < end) {
+                x.loadFlags(&blockCovered_[begin]);
+                for (int64_t slot = begin; slot < end; ++slot) {
+                    x.compareFlag(static_cast<uint8_t>(slot - begin));
+                    guards.push_back({ x.jump(X86Writer::NOT_EQUAL), i + 1, d.next });
+                }
+            }
+            break;
+        }
+        case JUMP:
+            jumpTo(d.operand);
+            ended = true;
+            break;
+        case JUMP_ZERO:
+        case JUMP_NOT_ZERO: {
+            x.compareRegisterWithZero(d.first);
+            size_t notTaken = x.jump(d.handler == JUMP_ZERO ? X86Writer::NOT_EQUAL : X86Writer::EQUAL);
+            jumpTo(d.operand);
+            x.bind(notTaken, x.position());
+            jumpTo(d.next);
+            ended = true;
+            break;
+        }
+        case BLOCK_END:
+            jumpTo(d.next);
+            ended = true;
+            break;
+        default:
+            break;
+        }
+        if (ended) break;
+    }
+
+    x.bind(shortBudget, x.position());
+    x.addBudget(block.count);
+    x.exit(address, false);
+
+    for (const Guard& guard : guards) {
+        x.bind(guard.site, x.position());
+        x.addBudget(block.count - guard.executed);
+        x.exit(guard.next, true);
+    }
+
+    jitCode_->endWrite();
+    block.native = static_cast<int32_t>(entry);
+    ++compiledCount_;
+    return block;
+}
+
+#endif // SIMULATOR_JIT
@@ -0,0 +1,116 @@
+#include "simulator/loader.h"
+#include "exceptions/simulatorexception.h"
+#include "simulator/relocator.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+std::string upperCase(const std::string& name)
+{
+    std::string upperName = name;
+    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+    return upperName;
+}
+
+} // namespace
+
+LoadedProgram Loader::load(const ObjectProgram& program, Memory& memory, int loadAddress)
+{
+    std::vector<uint8_t> image;
+    LoadedProgram loaded = loadImage(program, image, loadAddress);
+    memory.writeBytes(static_cast<uint32_t>(loaded.loadAddress), image.data(), image.size());
+    return loaded;
+}
+
+LoadedProgram Loader::loadImage(const ObjectProgram& program, std::vector<uint8_t>& image, int loadAddress)
+{
+    const std::vector<ObjectProgram::Section>& sections = program.getSections();
+
+    LoadedProgram loaded;
+    loaded.loadAddress = loadAddress < 0 ? sections.front().startAddress : loadAddress;
+
+    for (const auto& section : sections) {
+        if (loaded.sections.find(section.name) != -1) {
+            throw SimulatorException("Все имена секций должны быть уникальными: " + section.name);
+        }
+        size_t index = loaded.sections.add(Section(section.name, section.startAddress, section.entryAddress, section.length));
+        if (!loaded.lineTable.decode(index, section.lines.data(), section.lines.size())) {
+            throw SimulatorException("Неверная таблица строк секции " + section.name);
+        }
+    }
+    loaded.length = loaded.sections.getTotalLength();
+
+    if (static_cast<int64_t>(loaded.loadAddress) + loaded.length > static_cast<int64_t>(Memory::SIZE)) {
+        throw SimulatorException("Программа не помещается в память: " + sections.front().name);
+    }
+
+    // Addresses of the D names once the sections are placed
+    std::unordered_map<std::string, uint32_t> definitions;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        uint32_t base = static_cast<uint32_t>(loaded.loadAddress + loaded.sections.getOffset(i));
+        for (const auto& definition : sections[i].definitions) {
+            definitions[upperCase(definition.name)] = base + static_cast<uint32_t>(definition.address - sections[i].startAddress);
+        }
+    }
+
+    image.assign(static_cast<size_t>(loaded.length), 0);
+    std::vector<uint32_t> offsets; // Of the fields moved with the section
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const ObjectProgram::Section& section = sections[i];
+        uint32_t offset = static_cast<uint32_t>(loaded.sections.getOffset(i));
+        uint32_t base = static_cast<uint32_t>(loaded.loadAddress) + offset;
+        uint32_t delta = base - static_cast<uint32_t>(section.startAddress); // Added to every relocated field
+
+        for (const auto& text : section.texts) {
+            if (text.address < section.startAddress || text.address + text.length > section.startAddress + section.length) {
+                throw SimulatorException("Запись текста вне секции " + section.name);
+            }
+            if (!text.bytes.empty()) {
+                std::memcpy(&image[offset + (text.address - section.startAddress)], text.bytes.data(), text.bytes.size());
+            }
+        }
+
+        // R names of the section; M records name internal symbols as well
+        std::unordered_set<std::string> references;
+        for (const auto& reference : section.references) {
+            references.insert(upperCase(reference));
+        }
+
+        offsets.clear();
+        offsets.reserve(section.modifications.size());
+        for (const auto& modification : section.modifications) {
+            // M records hold the address of the command; its operand follows the opcode byte
+            if (modification.address < section.startAddress || modification.address + 4 > section.startAddress + section.length) {
+                throw SimulatorException("Запись модификации вне секции " + section.name);
+            }
+            uint32_t field = offset + static_cast<uint32_t>(modification.address - section.startAddress) + 1;
+
+            if (!modification.symbol.empty() && !references.empty()) {
+                std::string name = upperCase(modification.symbol);
+                if (references.count(name) != 0) {
+                    auto it = definitions.find(name);
+                    if (it == definitions.end()) {
+                        throw SimulatorException("Внешнее имя не определено: " + modification.symbol);
+                    }
+                    Relocator::apply(image.data(), &field, 1, it->second);
+                    continue;
+                }
+            }
+            offsets.push_back(field);
+        }
+
+        // The assembler writes M records in address order; the sum does not depend on the order
+        if (!std::is_sorted(offsets.begin(), offsets.end())) {
+            std::sort(offsets.begin(), offsets.end());
+        }
+        Relocator::apply(image.data(), offsets.data(), offsets.size(), delta);
+    }
+
+    const ObjectProgram::Section& first = sections.front();
+    loaded.entryAddress = loaded.loadAddress + first.entryAddress - first.startAddress;
+    return loaded;
+}
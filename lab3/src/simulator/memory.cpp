@@ -0,0 +1,86 @@
+#include "simulator/memory.h"
+#include <algorithm>
+#include <cstring>
+
+alignas(64) uint8_t Memory::zeroPage_[PAGE_SIZE] = {};
+
+constexpr Memory::Table Memory::makeZeroTable()
+{
+    Table table{};
+    for (uint32_t i = 0; i < TABLE_PAGES; ++i) {
+        table.pages[i] = zeroPage_;
+    }
+    return table;
+}
+
+// Constant-initialized, so it is ready before any dynamic initialization uses a Memory
+Memory::Table Memory::zeroTable_ = Memory::makeZeroTable();
+
+Memory::Memory()
+{
+    std::fill(directory_, directory_ + DIRECTORY_TABLES, &zeroTable_);
+}
+
+void Memory::writeBytes(uint32_t address, const uint8_t* data, size_t count)
+{
+    // Page by page
+    while (count > 0) {
+        address &= ADDRESS_MASK;
+        uint32_t offset = address & OFFSET_MASK;
+        size_t chunk = std::min<size_t>(count, PAGE_SIZE - offset);
+
+        // Zeros leave a page that is not allocated as it is
+        if (page(address) != zeroPage_ || std::memcmp(data, zeroPage_, chunk) != 0) {
+            std::memcpy(writablePage(address) + offset, data, chunk);
+        }
+        address += static_cast<uint32_t>(chunk);
+        data += chunk;
+        count -= chunk;
+    }
+}
+
+void Memory::clear()
+{
+    std::fill(directory_, directory_ + DIRECTORY_TABLES, &zeroTable_);
+    tables_.clear();
+    pages_.clear();
+}
+
+size_t Memory::getFootprint() const
+{
+    return pages_.size() * PAGE_SIZE + tables_.size() * sizeof(Table);
+}
+
+uint64_t Memory::digest() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint8_t byte) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    };
+
+    for (uint32_t address = 0; address < SIZE; address += PAGE_SIZE) {
+        const uint8_t* bytes = page(address);
+        if (bytes == zeroPage_ || std::all_of(bytes, bytes + PAGE_SIZE, [](uint8_t byte) { return byte == 0; })) {
+            continue;
+        }
+        mix(static_cast<uint8_t>(address >> 16));
+        mix(static_cast<uint8_t>(address >> 8));
+        for (uint32_t i = 0; i < PAGE_SIZE; ++i) {
+            mix(bytes[i]);
+        }
+    }
+    return hash;
+}
+
+uint8_t* Memory::allocatePage(uint32_t address)
+{
+    Table*& table = directory_[(address >> 18) & (DIRECTORY_TABLES - 1)];
+    if (table == &zeroTable_) {
+        tables_.emplace_back(new Table(zeroTable_));
+        table = tables_.back().get();
+    }
+
+    pages_.emplace_back(new uint8_t[PAGE_SIZE]());
+    table->pages[(address >> 12) & (TABLE_PAGES - 1)] = pages_.back().get();
+    return pages_.back().get();
+}
@@ -0,0 +1,164 @@
+#include "simulator/objectprogram.h"
+#include "exceptions/simulatorexception.h"
+
+namespace {
+
+std::vector<std::string_view> splitFields(std::string_view record)
+{
+    std::vector<std::string_view> fields;
+    size_t i = 0;
+    while (i < record.length()) {
+        while (i < record.length() && (record[i] == ' ' || record[i] == '\t' || record[i] == '\r')) ++i;
+        size_t begin = i;
+        while (i < record.length() && record[i] != ' ' && record[i] != '\t' && record[i] != '\r') ++i;
+        if (i > begin) {
+            fields.push_back(record.substr(begin, i - begin));
+        }
+    }
+    return fields;
+}
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// At most six digits, so the value is a 24-bit address
+int parseHex(std::string_view field, std::string_view record)
+{
+    if (field.empty() || field.length() > 6) {
+        throw SimulatorException("Неверное шестнадцатеричное число в записи: " + std::string(record));
+    }
+    int value = 0;
+    for (char c : field) {
+        int digit = hexDigit(c);
+        if (digit < 0) {
+            throw SimulatorException("Неверное шестнадцатеричное число в записи: " + std::string(record));
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+} // namespace
+
+ObjectProgram ObjectProgram::parse(const std::vector<std::string>& records)
+{
+    ObjectProgram program;
+    Section* section = nullptr;
+
+    for (const auto& record : records) {
+        std::vector<std::string_view> fields = splitFields(record);
+        if (fields.empty()) continue;
+
+        if (fields[0].length() != 1) {
+            throw SimulatorException("Неизвестная запись: " + record);
+        }
+        char type = fields[0][0];
+
+        if (type == 'H') {
+            if (fields.size() != 4) {
+                throw SimulatorException("Неверная запись заголовка: " + record);
+            }
+            program.sections_.emplace_back();
+            section = &program.sections_.back();
+            section->name = std::string(fields[1]);
+            section->startAddress = parseHex(fields[2], record);
+            section->length = parseHex(fields[3], record);
+            section->entryAddress = section->startAddress;
+            continue;
+        }
+
+        if (section == nullptr) {
+            throw SimulatorException("Запись до заголовка секции: " + record);
+        }
+
+        switch (type) {
+        case 'D':
+            if (fields.size() != 3) {
+                throw SimulatorException("Неверная запись внешнего имени: " + record);
+            }
+            section->definitions.push_back({ std::string(fields[1]), parseHex(fields[2], record) });
+            break;
+
+        case 'R':
+            if (fields.size() != 2) {
+                throw SimulatorException("Неверная запись внешней ссылки: " + record);
+            }
+            section->references.emplace_back(fields[1]);
+            break;
+
+        case 'T': {
+            if (fields.size() != 3 && fields.size() != 4) {
+                throw SimulatorException("Неверная запись текста: " + record);
+            }
+            Text text;
+            text.address = parseHex(fields[1], record);
+            text.length = parseHex(fields[2], record);
+            if (fields.size() == 4) {
+                std::string_view data = fields[3];
+                if (data.length() != static_cast<size_t>(text.length) * 2) {
+                    throw SimulatorException("Длина данных не совпадает с длиной записи: " + record);
+                }
+                text.bytes.reserve(text.length);
+                for (size_t i = 0; i < data.length(); i += 2) {
+                    text.bytes.push_back(static_cast<uint8_t>(parseHex(data.substr(i, 2), record)));
+                }
+            }
+            section->texts.push_back(std::move(text));
+            break;
+        }
+
+        case 'M':
+            if (fields.size() != 2 && fields.size() != 3) {
+                throw SimulatorException("Неверная запись модификации: " + record);
+            }
+            section->modifications.push_back({ parseHex(fields[1], record), fields.size() == 3 ? std::string(fields[2]) : std::string() });
+            break;
+
+        case 'L': {
+            if (fields.size() != 2 || fields[1].length() % 2 != 0) {
+                throw SimulatorException("Неверная запись таблицы строк: " + record);
+            }
+            std::string_view data = fields[1];
+            section->lines.reserve(section->lines.size() + data.length() / 2);
+            for (size_t i = 0; i < data.length(); i += 2) {
+                section->lines.push_back(static_cast<uint8_t>(parseHex(data.substr(i, 2), record)));
+            }
+            break;
+        }
+
+        case 'E':
+            if (fields.size() != 2) {
+                throw SimulatorException("Неверная запись конца секции: " + record);
+            }
+            section->entryAddress = parseHex(fields[1], record);
+            break;
+
+        default:
+            throw SimulatorException("Неизвестная запись: " + record);
+        }
+    }
+
+    if (program.sections_.empty()) {
+        throw SimulatorException("В объектном модуле нет ни одной секции");
+    }
+
+    return program;
+}
+
+ObjectProgram ObjectProgram::fromText(std::string_view text)
+{
+    std::vector<std::string> records;
+    size_t begin = 0;
+    while (begin < text.length()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string_view::npos) end = text.length();
+        records.emplace_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return parse(records);
+}
@@ -0,0 +1,129 @@
+#include "simulator/profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+Profiler::Profiler(const Simulator::Profile& profile, const LoadedProgram& program, const LineTable& lineTable)
+    : total_(0), unmapped_(0), opcodeCounts_(profile.opcodeCounts)
+{
+    size_t lineCount = 0;
+    for (const auto& entry : lineTable.getEntries()) {
+        lineCount = std::max<size_t>(lineCount, entry.line + 1);
+    }
+    lineCounts_.assign(lineCount, 0);
+    lineAddresses_.assign(lineCount, -1);
+
+    for (const auto& entry : lineTable.getEntries()) {
+        if (entry.section < program.sections.size()) {
+            const Section& section = program.sections[entry.section];
+            lineAddresses_[entry.line] = program.loadAddress + program.sections.getOffset(entry.section)
+                                         + entry.address - section.getStartAddress();
+        }
+    }
+
+    for (size_t offset = 0; offset < profile.addressCounts.size(); ++offset) {
+        uint64_t count = profile.addressCounts[offset];
+        if (count == 0) continue;
+        total_ += count;
+
+        int programOffset = static_cast<int>(profile.codeBegin + offset) - program.loadAddress;
+        int section = program.sections.findByOffset(programOffset);
+        int entry = -1;
+        if (section != -1) {
+            int address = program.sections[section].getStartAddress() + programOffset - program.sections.getOffset(section);
+            entry = lineTable.find(static_cast<size_t>(section), address);
+        }
+        if (entry == -1) {
+            unmapped_ += count;
+            continue;
+        }
+        lineCounts_[lineTable[entry].line] += count;
+    }
+}
+
+std::vector<std::string_view> Profiler::splitLines(std::string_view source)
+{
+    std::vector<std::string_view> lines;
+    size_t begin = 0;
+    while (begin < source.size()) {
+        size_t end = source.find('\n', begin);
+        if (end == std::string_view::npos) end = source.size();
+        std::string_view line = source.substr(begin, end - begin);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        lines.push_back(line);
+        begin = end + 1;
+    }
+    return lines;
+}
+
+std::string Profiler::annotatedListing(std::string_view source) const
+{
+    std::vector<std::string_view> text = splitLines(source);
+    std::vector<uint64_t> counts(text.size(), 0);
+    std::vector<int> addresses(text.size(), -1);
+    for (size_t line = 1; line < lineCounts_.size() && line <= text.size(); ++line) {
+        counts[line - 1] = lineCounts_[line];
+        addresses[line - 1] = lineAddresses_[line];
+    }
+
+    std::string listing = "     Команд       %  Адрес   Строка\n";
+    char prefix[64];
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (counts[i] != 0) {
+            std::snprintf(prefix, sizeof(prefix), "%11llu %6.2f  %06X  ", static_cast<unsigned long long>(counts[i]),
+                          100.0 * counts[i] / total_, static_cast<unsigned>(addresses[i]));
+        } else if (addresses[i] != -1) {
+            std::snprintf(prefix, sizeof(prefix), "%11s %6s  %06X  ", "", "", static_cast<unsigned>(addresses[i]));
+        } else {
+            std::snprintf(prefix, sizeof(prefix), "%11s %6s  %6s  ", "", "", "");
+        }
+        listing += prefix;
+        listing.append(text[i].data(), text[i].size());
+        listing += '\n';
+    }
+    return listing;
+}
+
+std::string Profiler::flatProfile(std::string_view source, const CommandTable& commands) const
+{
+    std::vector<std::string_view> text = splitLines(source);
+    std::vector<size_t> order;
+    for (size_t line = 0; line < lineCounts_.size(); ++line) {
+        if (lineCounts_[line] != 0) order.push_back(line);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return lineCounts_[a] > lineCounts_[b]; });
+
+    char row[128];
+    std::snprintf(row, sizeof(row), "Всего команд: %llu, вне строк программы: %llu\n\n",
+                  static_cast<unsigned long long>(total_), static_cast<unsigned long long>(unmapped_));
+    std::string report = row;
+    report += "      %   Сумма %      Команд  Строка  Адрес   Текст\n";
+
+    uint64_t cumulative = 0;
+    for (size_t line : order) {
+        cumulative += lineCounts_[line];
+        std::snprintf(row, sizeof(row), "%7.2f %8.2f %11llu %7zu  %06X  ", 100.0 * lineCounts_[line] / total_, 100.0 * cumulative / total_,
+                      static_cast<unsigned long long>(lineCounts_[line]), line, static_cast<unsigned>(lineAddresses_[line]));
+        report += row;
+        if (line >= 1 && line <= text.size()) report.append(text[line - 1].data(), text[line - 1].size());
+        report += '\n';
+    }
+
+    // Opcode byte = code * 4 + addressing type
+    uint64_t opcodeTotal = 0;
+    std::vector<size_t> opcodes;
+    for (size_t opcode = 0; opcode < opcodeCounts_.size(); ++opcode) {
+        if (opcodeCounts_[opcode] == 0) continue;
+        opcodeTotal += opcodeCounts_[opcode];
+        opcodes.push_back(opcode);
+    }
+    std::stable_sort(opcodes.begin(), opcodes.end(), [this](size_t a, size_t b) { return opcodeCounts_[a] > opcodeCounts_[b]; });
+
+    report += "\nКод  Команда     Тип       Команд       %\n";
+    for (size_t opcode : opcodes) {
+        const Command* command = commands.findByCode(static_cast<int>(opcode >> 2));
+        std::snprintf(row, sizeof(row), "%02zX   %-10s  %3zu  %11llu  %6.2f\n", opcode, command != nullptr ? command->getName().c_str() : "?",
+                      opcode & 3, static_cast<unsigned long long>(opcodeCounts_[opcode]), 100.0 * opcodeCounts_[opcode] / opcodeTotal);
+        report += row;
+    }
+    return report;
+}
@@ -0,0 +1,13 @@
+#include "simulator/relocator.h"
+
+void Relocator::apply(uint8_t* image, const uint32_t* offsets, size_t count, uint32_t delta)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* bytes = image + offsets[i];
+        uint32_t value = (static_cast<uint32_t>(bytes[0]) << 16) | (static_cast<uint32_t>(bytes[1]) << 8) | bytes[2];
+        value += delta;
+        bytes[0] = static_cast<uint8_t>(value >> 16);
+        bytes[1] = static_cast<uint8_t>(value >> 8);
+        bytes[2] = static_cast<uint8_t>(value);
+    }
+}
@@ -0,0 +1,73 @@
+#include "simulator/semantics.h"
+#include "exceptions/simulatorexception.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Register of "LOADR1"-like names: prefix then 1..16; 0 if the name is different
+int registerSuffix(const std::string& name, const std::string& prefix)
+{
+    if (name.compare(0, prefix.length(), prefix) != 0 || name.length() == prefix.length() || name.length() > prefix.length() + 2) {
+        return 0;
+    }
+    int number = 0;
+    for (size_t i = prefix.length(); i < name.length(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return 0;
+        number = number * 10 + (name[i] - '0');
+    }
+    return number >= 1 && number <= 16 ? number : 0;
+}
+
+} // namespace
+
+SemanticsTable::SemanticsTable()
+{
+}
+
+SemanticsTable::SemanticsTable(const CommandTable& commands)
+{
+    for (const auto& command : commands.getCommands()) {
+        if (command.getCode() >= CODE_COUNT) continue;
+
+        std::string name = command.getName();
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+        if (name == "JMP") {
+            set(command, Operation::JUMP);
+        } else if (name == "JZ") {
+            set(command, Operation::JUMP_ZERO);
+        } else if (name == "JNZ") {
+            set(command, Operation::JUMP_NOT_ZERO);
+        } else if (name == "ADD") {
+            set(command, Operation::ADD);
+        } else if (name == "SUB") {
+            set(command, Operation::SUB);
+        } else if (name == "INT") {
+            set(command, Operation::INTERRUPT);
+        } else if (name == "NOP") {
+            set(command, Operation::NOP);
+        } else if (name == "HALT") {
+            set(command, Operation::HALT);
+        } else if (int loadRegister = registerSuffix(name, "LOADR")) {
+            set(command, Operation::LOAD, loadRegister - 1);
+        } else if (int saveRegister = registerSuffix(name, "SAVER")) {
+            set(command, Operation::STORE, saveRegister - 1);
+        }
+    }
+}
+
+void SemanticsTable::set(const Command& command, Operation operation, int registerNumber)
+{
+    if (command.getCode() < 0 || command.getCode() >= CODE_COUNT) {
+        throw SimulatorException("Код команды не помещается в байт кода операции: " + command.getName());
+    }
+    if (registerNumber < 0 || registerNumber > 15) {
+        throw SimulatorException("Неверный номер регистра для команды " + command.getName());
+    }
+
+    Entry& entry = entries_[command.getCode()];
+    entry.operation = operation;
+    entry.registerNumber = static_cast<uint8_t>(registerNumber);
+    entry.length = static_cast<uint8_t>(command.getLength());
+}
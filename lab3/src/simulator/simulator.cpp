@@ -0,0 +1,562 @@
+#include "simulator/simulator.h"
+#include <algorithm>
+#include <cstring>
+
+// Threaded dispatch through a table of label addresses where the compiler supports it
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMULATOR_COMPUTED_GOTO 1
+#endif
+
+Simulator::Simulator(const SemanticsTable& semantics)
+    : semantics_(semantics), ip_(0), instructionCount_(0), interruptNumber_(0), codeBegin_(0),
+      blockCacheEnabled_(true), blocksStale_(false), blockCount_(0), jitEnabled_(false), compiledCount_(0), profiling_(false)
+{
+    std::fill(registers_, registers_ + REGISTER_COUNT, 0);
+    std::fill(opcodeCounts_, opcodeCounts_ + 256, 0);
+}
+
+const LoadedProgram& Simulator::load(const ObjectProgram& program, int loadAddress)
+{
+    memory_.clear();
+    program_ = Loader::load(program, memory_, loadAddress);
+
+    std::fill(registers_, registers_ + REGISTER_COUNT, 0);
+    ip_ = static_cast<uint32_t>(program_.entryAddress);
+    instructionCount_ = 0;
+    interruptNumber_ = 0;
+
+    setCodeRange(static_cast<uint32_t>(program_.loadAddress), static_cast<uint32_t>(program_.loadAddress + program_.length));
+    resetProfile();
+    return program_;
+}
+
+void Simulator::setCodeRange(uint32_t begin, uint32_t end)
+{
+    codeBegin_ = begin;
+    code_.assign(end > begin ? end - begin : 0, Decoded());
+    blockAt_.assign(blockCacheEnabled_ ? code_.size() : 0, Block()); // Empty without blocks, so run finds none
+    blockCovered_.assign(code_.size(), 0);
+    blockCount_ = 0;
+    blockOps_.clear();
+    blockRuns_.clear();
+    blocksStale_ = false;
+    addressCounts_.assign(code_.size(), 0);
+    flushNative(); // The old native code jumps between the old blocks
+}
+
+void Simulator::invalidateCode()
+{
+    for (auto& decoded : code_) {
+        decoded.handler = DECODE;
+    }
+    flushBlocks();
+}
+
+void Simulator::setBlockCacheEnabled(bool enabled)
+{
+    // Stores do not keep the other cache up to date
+    blockCacheEnabled_ = enabled;
+    invalidateCode();
+    blockAt_.assign(enabled ? code_.size() : 0, Block());
+}
+
+void Simulator::setProfilingEnabled(bool enabled)
+{
+    // Blocks are translated again with their counters, and compiled ones are dropped
+    profiling_ = enabled;
+    flushBlocks();
+}
+
+void Simulator::resetProfile()
+{
+    foldBlockRuns();
+    std::fill(addressCounts_.begin(), addressCounts_.end(), 0);
+    std::fill(opcodeCounts_, opcodeCounts_ + 256, 0);
+}
+
+Simulator::Profile Simulator::getProfile()
+{
+    foldBlockRuns();
+    Profile profile;
+    profile.codeBegin = codeBegin_;
+    profile.addressCounts = addressCounts_;
+    profile.opcodeCounts.assign(opcodeCounts_, opcodeCounts_ + 256);
+    return profile;
+}
+
+void Simulator::foldBlockRuns()
+{
+    for (const Block& block : blockAt_) {
+        if (block.count == 0 || block.firstOp >= blockRuns_.size() || blockRuns_[block.firstOp] == 0) {
+            continue;
+        }
+        uint64_t runs = blockRuns_[block.firstOp];
+        for (uint32_t i = block.firstOp; i < block.firstOp + block.count; ++i) {
+            const Decoded& d = blockOps_[i];
+            countCommand((d.next - d.length) & Memory::ADDRESS_MASK, d.opcode, runs);
+        }
+        blockRuns_[block.firstOp] = 0;
+    }
+}
+
+void Simulator::flushBlocks()
+{
+    foldBlockRuns();
+    blockRuns_.clear();
+    std::fill(blockAt_.begin(), blockAt_.end(), Block());
+    std::fill(blockCovered_.begin(), blockCovered_.end(), 0);
+    blockCount_ = 0;
+    blockOps_.clear();
+    blocksStale_ = false;
+
+    // Native code refers to the blocks and jumps between them
+    if (jitCode_) {
+        jitCode_->clear();
+    }
+    compiledCount_ = 0;
+}
+
+Simulator::Block Simulator::translateBlock(uint32_t index)
+{
+    // Commands up to a jump, INT or HALT; an illegal command or the end of the code range ends the block before it
+    Block block;
+    block.firstOp = static_cast<uint32_t>(blockOps_.size());
+    uint32_t address = codeBegin_ + index;
+    while (block.count < MAX_BLOCK_LENGTH && address - codeBegin_ < code_.size()) {
+        Decoded decoded;
+        decode(address, decoded);
+        if (decoded.handler == ILLEGAL) break;
+
+        bindOperand(decoded);
+        blockOps_.push_back(decoded);
+        ++block.count;
+        for (uint32_t i = 0; i < decoded.length; ++i) {
+            uint32_t covered = address - codeBegin_ + i;
+            if (covered < blockCovered_.size()) blockCovered_[covered] = 1;
+        }
+        address = decoded.next;
+        if (endsBlock(decoded.handler)) break;
+    }
+
+    if (block.count == 0) {
+        return block;
+    }
+
+    Decoded end;
+    end.handler = BLOCK_END;
+    end.next = address;
+    blockOps_.push_back(end);
+
+    ++blockCount_;
+    blockAt_[index] = block;
+    if (profiling_) {
+        blockRuns_.resize(blockOps_.size());
+    }
+    return block;
+}
+
+void Simulator::bindOperand(Decoded& decoded)
+{
+    // Pages stay in place until the memory is cleared, which flushes the blocks
+    switch (decoded.handler) {
+    case LOAD:
+    case ADD_MEMORY:
+    case SUB_MEMORY:
+        decoded.bytes = memory_.findBytes(decoded.operand, 3);
+        if (decoded.bytes != nullptr) {
+            decoded.handler = decoded.handler == LOAD ? LOAD_DIRECT : decoded.handler == ADD_MEMORY ? ADD_MEMORY_DIRECT : SUB_MEMORY_DIRECT;
+        }
+        break;
+    case STORE:
+        // Stores into the code range keep the STORE handler, which checks the blocks
+        decoded.bytes = memory_.findBytes(decoded.operand, 3);
+        if (!reachesCode(decoded.operand)) {
+            decoded.handler = decoded.bytes != nullptr ? STORE_DIRECT : STORE_OUTSIDE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void Simulator::decode(uint32_t address, Decoded& decoded) const
+{
+    uint8_t opcode = memory_.read8(address);
+    const SemanticsTable::Entry& entry = semantics_.at(opcode >> 2);
+    int addressingType = opcode & 3;
+
+    decoded = Decoded();
+    decoded.handler = ILLEGAL;
+    decoded.length = entry.length;
+    decoded.first = entry.registerNumber;
+    decoded.opcode = opcode;
+    decoded.next = (address + entry.length) & Memory::ADDRESS_MASK;
+
+    if (entry.operation == Operation::NONE) {
+        return;
+    }
+
+    if (entry.length == 4) {
+        if (addressingType == 3) return;
+        uint32_t operand = memory_.read24(address + 1);
+        decoded.operand = addressingType == 2 ? (address + 4 + operand) & Memory::ADDRESS_MASK : operand;
+    } else if (entry.length == 2) {
+        uint8_t operand = memory_.read8(address + 1);
+        decoded.first = operand >> 4;
+        decoded.second = operand & 0x0F;
+        decoded.operand = operand;
+    }
+
+    switch (entry.operation) {
+    case Operation::NONE:
+        break;
+    case Operation::NOP:
+        decoded.handler = NOP;
+        break;
+    case Operation::LOAD:
+        if (entry.length == 4) decoded.handler = LOAD;
+        break;
+    case Operation::STORE:
+        if (entry.length == 4) decoded.handler = STORE;
+        break;
+    case Operation::ADD:
+        if (entry.length == 2) decoded.handler = ADD_REGISTERS;
+        if (entry.length == 4) decoded.handler = ADD_MEMORY;
+        break;
+    case Operation::SUB:
+        if (entry.length == 2) decoded.handler = SUB_REGISTERS;
+        if (entry.length == 4) decoded.handler = SUB_MEMORY;
+        break;
+    case Operation::JUMP:
+        if (entry.length == 4) decoded.handler = JUMP;
+        break;
+    case Operation::JUMP_ZERO:
+        if (entry.length == 4) decoded.handler = JUMP_ZERO;
+        break;
+    case Operation::JUMP_NOT_ZERO:
+        if (entry.length == 4) decoded.handler = JUMP_NOT_ZERO;
+        break;
+    case Operation::INTERRUPT:
+        decoded.handler = INTERRUPT;
+        break;
+    case Operation::HALT:
+        decoded.handler = HALT;
+        break;
+    }
+}
+
+Simulator::StopReason Simulator::interpret(uint64_t maxInstructions)
+{
+    // Registers are kept in a local copy: stores to memory bytes could alias the members
+    uint32_t r[REGISTER_COUNT];
+    std::memcpy(r, registers_, sizeof(r));
+    uint32_t ip = ip_;
+    uint64_t executed = 0;
+    StopReason reason = LIMIT_REACHED;
+    Decoded* d;
+
+#ifdef SIMULATOR_COMPUTED_GOTO
+    static const void* const handlers[HANDLER_COUNT] = {
+        &&handler_DECODE, &&handler_ILLEGAL, &&handler_NOP, &&handler_LOAD, &&handler_STORE,
+        &&handler_ADD_REGISTERS, &&handler_ADD_MEMORY, &&handler_SUB_REGISTERS, &&handler_SUB_MEMORY,
+        &&handler_JUMP, &&handler_JUMP_ZERO, &&handler_JUMP_NOT_ZERO, &&handler_INTERRUPT, &&handler_HALT,
+        &&handler_ILLEGAL, &&handler_ILLEGAL, &&handler_ILLEGAL, &&handler_ILLEGAL, &&handler_ILLEGAL, &&handler_ILLEGAL
+    };
+#define HANDLER(name) case name: handler_##name:
+#define NEXT() do { if (executed == maxInstructions) goto stop; d = fetch(ip); ++executed; goto *handlers[d->handler]; } while (0)
+#else
+#define HANDLER(name) case name:
+#define NEXT() continue
+#endif
+
+    for (;;) {
+        if (executed == maxInstructions) goto stop;
+        d = fetch(ip);
+        ++executed;
+
+    dispatch:
+        switch (d->handler) {
+        HANDLER(DECODE)
+            decode(ip, *d);
+            goto dispatch;
+
+        HANDLER(ILLEGAL)
+            --executed;
+            reason = FAULT;
+            goto stop;
+
+        HANDLER(NOP)
+            ip = d->next;
+            NEXT();
+
+        HANDLER(LOAD)
+            r[d->first] = memory_.read24(d->operand);
+            ip = d->next;
+            NEXT();
+
+        HANDLER(STORE)
+            memory_.write24(d->operand, r[d->first]);
+            if (invalidateStore(d->operand)) blocksStale_ = true;
+            ip = d->next;
+            NEXT();
+
+        HANDLER(ADD_REGISTERS)
+            r[d->first] = (r[d->first] + r[d->second]) & Memory::ADDRESS_MASK;
+            ip = d->next;
+            NEXT();
+
+        HANDLER(ADD_MEMORY)
+            r[d->first] = (r[d->first] + memory_.read24(d->operand)) & Memory::ADDRESS_MASK;
+            ip = d->next;
+            NEXT();
+
+        HANDLER(SUB_REGISTERS)
+            r[d->first] = (r[d->first] - r[d->second]) & Memory::ADDRESS_MASK;
+            ip = d->next;
+            NEXT();
+
+        HANDLER(SUB_MEMORY)
+            r[d->first] = (r[d->first] - memory_.read24(d->operand)) & Memory::ADDRESS_MASK;
+            ip = d->next;
+            NEXT();
+
+        HANDLER(JUMP)
+            ip = d->operand;
+            NEXT();
+
+        HANDLER(JUMP_ZERO)
+            ip = r[d->first] == 0 ? d->operand : d->next;
+            NEXT();
+
+        HANDLER(JUMP_NOT_ZERO)
+            ip = r[d->first] != 0 ? d->operand : d->next;
+            NEXT();
+
+        HANDLER(INTERRUPT)
+            interruptNumber_ = d->operand;
+            ip = d->next;
+            reason = INTERRUPTED;
+            goto stop;
+
+        HANDLER(HALT)
+            ip = d->next;
+            reason = HALTED;
+            goto stop;
+
+        default:
+            --executed;
+            reason = FAULT;
+            goto stop;
+        }
+    }
+
+#undef HANDLER
+#undef NEXT
+
+stop:
+    std::memcpy(registers_, r, sizeof(r));
+    ip_ = ip;
+    instructionCount_ += executed;
+    return reason;
+}
+
+Simulator::StopReason Simulator::run(uint64_t maxInstructions)
+{
+    if (!blockCacheEnabled_ && !profiling_) {
+        return interpret(maxInstructions);
+    }
+
+    uint32_t r[REGISTER_COUNT];
+    std::memcpy(r, registers_, sizeof(r));
+    uint32_t ip = ip_;
+    uint64_t executed = 0; // Includes the commands of the current block that are not run yet
+    StopReason reason = LIMIT_REACHED;
+    const Decoded* d;
+    const Decoded* begin; // First command of the current block
+    const Decoded* end;   // BLOCK_END of the current block
+
+#ifdef SIMULATOR_COMPUTED_GOTO
+    static const void* const handlers[HANDLER_COUNT] = {
+        &&handler_DECODE, &&handler_ILLEGAL, &&handler_NOP, &&handler_LOAD, &&handler_STORE,
+        &&handler_ADD_REGISTERS, &&handler_ADD_MEMORY, &&handler_SUB_REGISTERS, &&handler_SUB_MEMORY,
+        &&handler_JUMP, &&handler_JUMP_ZERO, &&handler_JUMP_NOT_ZERO, &&handler_INTERRUPT, &&handler_HALT,
+        &&handler_LOAD_DIRECT, &&handler_ADD_MEMORY_DIRECT, &&handler_SUB_MEMORY_DIRECT, &&handler_STORE_DIRECT,
+        &&handler_STORE_OUTSIDE, &&handler_BLOCK_END
+    };
+#define HANDLER(name) case name: handler_##name:
+#define DISPATCH() goto *handlers[d->handler]
+#else
+#define HANDLER(name) case name:
+#define DISPATCH() goto dispatch
+#endif
+#define NEXT_COMMAND() do { ++d; DISPATCH(); } while (0)
+#define OPERAND_WORD() ((static_cast<uint32_t>(d->bytes[0]) << 16) | (static_cast<uint32_t>(d->bytes[1]) << 8) | d->bytes[2])
+
+next_block:
+    // A block is never empty, so this also checks the limit
+    if (ip - codeBegin_ < blockAt_.size()) {
+        Block block = blockAt(ip - codeBegin_);
+#ifdef SIMULATOR_JIT
+        if (jitEnabled_ && !profiling_ && block.count != 0 && block.native == NOT_COMPILED && ++blockAt_[ip - codeBegin_].runs >= JIT_THRESHOLD) {
+            block = compileBlock(ip - codeBegin_);
+        }
+        if (block.native >= 0 && block.count <= maxInstructions - executed) {
+            // Runs on through compiled blocks until one jumps elsewhere or the budget is short
+            uint64_t budget = maxInstructions - executed;
+            uint64_t result = reinterpret_cast<NativeBlock>(jitCode_->data() + block.native)(r, &budget);
+            executed = maxInstructions - budget;
+            ip = static_cast<uint32_t>(result);
+            if (result >> 32) flushBlocks();
+            goto next_block;
+        }
+#endif
+        if (block.count != 0 && block.count <= maxInstructions - executed) {
+            d = begin = &blockOps_[block.firstOp];
+            end = d + block.count;
+            executed += block.count;
+            if (profiling_) ++blockRuns_[block.firstOp];
+            DISPATCH();
+        }
+    }
+    if (executed == maxInstructions) goto stop;
+
+    // No block fits: one command on its own, outside the code range, near the limit or with blocks off
+    {
+        uint64_t count = instructionCount_;
+        uint32_t address = ip;
+        uint8_t opcode = memory_.read8(ip);
+        std::memcpy(registers_, r, sizeof(r));
+        ip_ = ip;
+        reason = interpret(1);
+        std::memcpy(r, registers_, sizeof(r));
+        ip = ip_;
+        if (profiling_ && instructionCount_ != count) countCommand(address, opcode);
+        executed += instructionCount_ - count; // Added to the count once, at stop
+        instructionCount_ = count;
+        if (blocksStale_) flushBlocks();
+    }
+    if (reason == LIMIT_REACHED) goto next_block;
+    goto stop;
+
+#ifndef SIMULATOR_COMPUTED_GOTO
+dispatch:
+#endif
+    switch (d->handler) {
+    HANDLER(DECODE)
+    HANDLER(ILLEGAL)
+        // Blocks end before illegal commands
+        reason = FAULT;
+        goto stop;
+
+    HANDLER(NOP)
+        NEXT_COMMAND();
+
+    HANDLER(LOAD)
+        r[d->first] = memory_.read24(d->operand);
+        NEXT_COMMAND();
+
+    HANDLER(LOAD_DIRECT)
+        r[d->first] = OPERAND_WORD();
+        NEXT_COMMAND();
+
+    HANDLER(STORE)
+        if (d->bytes != nullptr) {
+            d->bytes[0] = static_cast<uint8_t>(r[d->first] >> 16);
+            d->bytes[1] = static_cast<uint8_t>(r[d->first] >> 8);
+            d->bytes[2] = static_cast<uint8_t>(r[d->first]);
+        } else {
+            memory_.write24(d->operand, r[d->first]);
+        }
+        if (invalidateStore(d->operand)) {
+            // The rest of the block may be stale: leave it after this command
+            executed -= static_cast<uint64_t>(end - d - 1);
+            if (profiling_) {
+                // The run counted for the whole block; only the commands up to here ran
+                --blockRuns_[begin - blockOps_.data()];
+                for (const Decoded* op = begin; op <= d; ++op) {
+                    countCommand((op->next - op->length) & Memory::ADDRESS_MASK, op->opcode);
+                }
+            }
+            ip = d->next;
+            flushBlocks();
+            goto next_block;
+        }
+        NEXT_COMMAND();
+
+    HANDLER(STORE_DIRECT)
+        d->bytes[0] = static_cast<uint8_t>(r[d->first] >> 16);
+        d->bytes[1] = static_cast<uint8_t>(r[d->first] >> 8);
+        d->bytes[2] = static_cast<uint8_t>(r[d->first]);
+        NEXT_COMMAND();
+
+    HANDLER(STORE_OUTSIDE)
+        memory_.write24(d->operand, r[d->first]);
+        NEXT_COMMAND();
+
+    HANDLER(ADD_REGISTERS)
+        r[d->first] = (r[d->first] + r[d->second]) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(ADD_MEMORY)
+        r[d->first] = (r[d->first] + memory_.read24(d->operand)) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(ADD_MEMORY_DIRECT)
+        r[d->first] = (r[d->first] + OPERAND_WORD()) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(SUB_REGISTERS)
+        r[d->first] = (r[d->first] - r[d->second]) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(SUB_MEMORY)
+        r[d->first] = (r[d->first] - memory_.read24(d->operand)) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(SUB_MEMORY_DIRECT)
+        r[d->first] = (r[d->first] - OPERAND_WORD()) & Memory::ADDRESS_MASK;
+        NEXT_COMMAND();
+
+    HANDLER(JUMP)
+        ip = d->operand;
+        goto next_block;
+
+    HANDLER(JUMP_ZERO)
+        ip = r[d->first] == 0 ? d->operand : d->next;
+        goto next_block;
+
+    HANDLER(JUMP_NOT_ZERO)
+        ip = r[d->first] != 0 ? d->operand : d->next;
+        goto next_block;
+
+    HANDLER(INTERRUPT)
+        interruptNumber_ = d->operand;
+        ip = d->next;
+        reason = INTERRUPTED;
+        goto stop;
+
+    HANDLER(HALT)
+        ip = d->next;
+        reason = HALTED;
+        goto stop;
+
+    HANDLER(BLOCK_END)
+        ip = d->next;
+        goto next_block;
+
+    default:
+        reason = FAULT;
+        goto stop;
+    }
+
+#undef HANDLER
+#undef DISPATCH
+#undef NEXT_COMMAND
+#undef OPERAND_WORD
+
+stop:
+    std::memcpy(registers_, r, sizeof(r));
+    ip_ = ip;
+    instructionCount_ += executed;
+    return reason;
+}
@@ -0,0 +1,52 @@
+#include "structures/crossreference.h"
+
+CrossReference::CrossReference()
+    : offsets_(1, 0)
+{
+}
+
+void CrossReference::clear()
+{
+    offsets_.assign(1, 0);
+    sites_.clear();
+    symbols_.clear();
+}
+
+size_t CrossReference::add(uint32_t symbol, size_t line, bool definition)
+{
+    Site site;
+    site.value = static_cast<uint32_t>(line << 1) | (definition ? 1u : 0u);
+    sites_.push_back(site);
+    symbols_.push_back(symbol);
+    return sites_.size() - 1;
+}
+
+void CrossReference::build(size_t symbolCount)
+{
+    // Counting sort by symbol; sites of one symbol keep their line order
+    offsets_.assign(symbolCount + 1, 0);
+    for (uint32_t symbol : symbols_) {
+        if (symbol < symbolCount) ++offsets_[symbol + 1];
+    }
+    for (size_t i = 0; i < symbolCount; ++i) {
+        offsets_[i + 1] += offsets_[i];
+    }
+
+    std::vector<Site> sorted(offsets_.back());
+    std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_t i = 0; i < sites_.size(); ++i) {
+        if (symbols_[i] < symbolCount) sorted[next[symbols_[i]]++] = sites_[i];
+    }
+
+    sites_ = std::move(sorted);
+    symbols_.clear();
+    symbols_.shrink_to_fit();
+}
+
+CrossReference::Sites CrossReference::getSites(size_t symbol) const
+{
+    if (symbol + 1 >= offsets_.size()) {
+        return Sites(nullptr, nullptr);
+    }
+    return Sites(sites_.data() + offsets_[symbol], sites_.data() + offsets_[symbol + 1]);
+}
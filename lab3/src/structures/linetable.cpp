@@ -0,0 +1,102 @@
+#include "structures/linetable.h"
+#include <algorithm>
+
+namespace {
+
+const uint8_t EXTENDED = 0x80;         // Followed by the line and address deltas as varints
+const uint32_t MAX_SHORT_LINE_DELTA = 4;
+const uint32_t MAX_SHORT_ADDRESS_DELTA = 31;
+
+void putVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// At most 5 bytes for 32 bits
+bool getVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && data < end; shift += 7) {
+        uint8_t byte = *data++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void LineTable::add(size_t line, size_t section, int address)
+{
+    Entry entry;
+    entry.line = static_cast<uint32_t>(line);
+    entry.section = static_cast<uint32_t>(section);
+    entry.address = address;
+    entries_.push_back(entry);
+}
+
+int LineTable::find(size_t section, int address) const
+{
+    // Entries are sorted by section, then address
+    auto after = std::upper_bound(entries_.begin(), entries_.end(), std::make_pair(static_cast<uint32_t>(section), address),
+                                  [](const std::pair<uint32_t, int>& key, const Entry& entry) {
+                                      return key.first < entry.section || (key.first == entry.section && key.second < entry.address);
+                                  });
+    if (after == entries_.begin() || (after - 1)->section != section) {
+        return -1;
+    }
+    return static_cast<int>(after - entries_.begin() - 1);
+}
+
+std::vector<uint8_t> LineTable::encode(size_t section) const
+{
+    auto begin = std::lower_bound(entries_.begin(), entries_.end(), static_cast<uint32_t>(section),
+                                  [](const Entry& entry, uint32_t key) { return entry.section < key; });
+
+    std::vector<uint8_t> program;
+    uint32_t line = 0;
+    int32_t address = 0;
+    for (auto it = begin; it != entries_.end() && it->section == section; ++it) {
+        uint32_t lineDelta = it->line - line;
+        uint32_t addressDelta = static_cast<uint32_t>(it->address - address);
+        if (lineDelta >= 1 && lineDelta <= MAX_SHORT_LINE_DELTA && addressDelta <= MAX_SHORT_ADDRESS_DELTA) {
+            program.push_back(static_cast<uint8_t>((lineDelta - 1) << 5 | addressDelta));
+        } else {
+            program.push_back(EXTENDED);
+            putVarint(program, lineDelta);
+            putVarint(program, addressDelta);
+        }
+        line = it->line;
+        address = it->address;
+    }
+    return program;
+}
+
+bool LineTable::decode(size_t section, const uint8_t* data, size_t size)
+{
+    const uint8_t* end = data + size;
+    size_t first = entries_.size();
+    uint32_t line = 0;
+    uint32_t address = 0;
+
+    while (data < end) {
+        uint8_t byte = *data++;
+        uint32_t lineDelta;
+        uint32_t addressDelta;
+        if (byte < EXTENDED) {
+            lineDelta = (byte >> 5) + 1;
+            addressDelta = byte & MAX_SHORT_ADDRESS_DELTA;
+        } else if (byte != EXTENDED || !getVarint(data, end, lineDelta) || !getVarint(data, end, addressDelta)) {
+            entries_.resize(first);
+            return false;
+        }
+        line += lineDelta;
+        address += addressDelta;
+        add(line, section, static_cast<int>(address));
+    }
+    return true;
+}
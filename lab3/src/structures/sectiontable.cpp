@@ -0,0 +1,48 @@
+#include "structures/sectiontable.h"
+#include <algorithm>
+#include <cctype>
+
+SectionTable::SectionTable()
+    : offsets_{ 0 }
+{
+}
+
+void SectionTable::clear()
+{
+    sections_.clear();
+    offsets_.assign(1, 0);
+    indexByName_.clear();
+}
+
+size_t SectionTable::add(const Section& section)
+{
+    size_t index = sections_.size();
+    indexByName_.emplace(upperCase(section.getName()), index);
+    sections_.push_back(section);
+    offsets_.push_back(offsets_.back() + section.getLength());
+    return index;
+}
+
+int SectionTable::find(const std::string& name) const
+{
+    auto it = indexByName_.find(upperCase(name));
+    return it != indexByName_.end() ? static_cast<int>(it->second) : -1;
+}
+
+int SectionTable::findByOffset(int offset) const
+{
+    if (offset < 0 || offset >= getTotalLength()) {
+        return -1;
+    }
+
+    // Last section starting at or before the offset; empty sections before it share its start
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end() - 1, offset);
+    return static_cast<int>(it - offsets_.begin()) - 1;
+}
+
+std::string SectionTable::upperCase(const std::string& name)
+{
+    std::string upperName = name;
+    std::transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+    return upperName;
+}
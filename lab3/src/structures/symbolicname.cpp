@@ -1,11 +1,29 @@
 #include "structures/symbolicname.h"
 
 SymbolicName::SymbolicName()
-    : name_(""), address_(-1), section_(""), type_("")
+    : name_(""), address_(-1), section_(""), kind_(LOCAL)
+{
+}
+
+SymbolicName::SymbolicName(const std::string& name, int address, const std::string& section, Kind kind)
+    : name_(name), address_(address), section_(section), kind_(kind)
 {
 }
 
 SymbolicName::SymbolicName(const std::string& name, int address, const std::string& section, const std::string& type)
-    : name_(name), address_(address), section_(section), type_(type)
+    : name_(name), address_(address), section_(section), kind_(kindFromType(type))
+{
+}
+
+const std::string& SymbolicName::typeName(Kind kind)
 {
-}
\ No newline at end of file
+    static const std::string names[] = { "", "ВИ", "ВС" };
+    return names[kind];
+}
+
+SymbolicName::Kind SymbolicName::kindFromType(const std::string& type)
+{
+    if (type == "ВИ") return EXTDEF;
+    if (type == "ВС") return EXTREF;
+    return LOCAL;
+}
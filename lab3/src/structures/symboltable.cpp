@@ -0,0 +1,110 @@
+#include "structures/symboltable.h"
+#include <cctype>
+
+namespace {
+
+const size_t INITIAL_SLOTS = 64;
+
+char upper(char c)
+{
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+}
+
+} // namespace
+
+SymbolTable::SymbolTable()
+    : nameOffsets_{ 0 }, slots_(INITIAL_SLOTS, -1)
+{
+}
+
+void SymbolTable::clear()
+{
+    namePool_.clear();
+    nameOffsets_.assign(1, 0);
+    addresses_.clear();
+    sections_.clear();
+    kinds_.clear();
+    hashes_.clear();
+    slots_.assign(INITIAL_SLOTS, -1);
+}
+
+size_t SymbolTable::add(std::string_view name, int address, size_t section, SymbolicName::Kind kind)
+{
+    size_t index = addresses_.size();
+    if ((index + 1) * 2 > slots_.size()) {
+        grow();
+    }
+
+    for (char c : name) {
+        namePool_ += upper(c);
+    }
+    nameOffsets_.push_back(static_cast<uint32_t>(namePool_.size()));
+
+    addresses_.push_back(address);
+    sections_.push_back(static_cast<uint32_t>(section));
+    kinds_.push_back(static_cast<uint8_t>(kind));
+    hashes_.push_back(hash(name, section));
+    insertSlot(static_cast<uint32_t>(index));
+
+    return index;
+}
+
+int SymbolTable::find(std::string_view name, size_t section) const
+{
+    uint32_t h = hash(name, section);
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = h & mask; slots_[slot] != -1; slot = (slot + 1) & mask) {
+        int32_t index = slots_[slot];
+        if (hashes_[index] == h && sections_[index] == section && matches(index, name)) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+std::string_view SymbolTable::getName(size_t index) const
+{
+    return std::string_view(namePool_).substr(nameOffsets_[index], nameOffsets_[index + 1] - nameOffsets_[index]);
+}
+
+uint32_t SymbolTable::hash(std::string_view name, size_t section)
+{
+    // FNV-1a, seeded with the section
+    uint32_t h = 2166136261u ^ static_cast<uint32_t>(section);
+    for (char c : name) {
+        h = (h ^ static_cast<unsigned char>(upper(c))) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+bool SymbolTable::matches(size_t index, std::string_view name) const
+{
+    std::string_view stored = getName(index);
+    if (stored.length() != name.length()) {
+        return false;
+    }
+    for (size_t i = 0; i < name.length(); ++i) {
+        if (stored[i] != upper(name[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SymbolTable::insertSlot(uint32_t index)
+{
+    size_t mask = slots_.size() - 1;
+    size_t slot = hashes_[index] & mask;
+    while (slots_[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    slots_[slot] = static_cast<int32_t>(index);
+}
+
+void SymbolTable::grow()
+{
+    slots_.assign(slots_.size() * 2, -1);
+    for (size_t i = 0; i < size(); ++i) {
+        insertSlot(static_cast<uint32_t>(i));
+    }
+}
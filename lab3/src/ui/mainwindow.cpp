@@ -6,6 +6,61 @@
 #include <QRegularExpression>
 #include <QScrollBar>
 #include <QComboBox>
+#include <QFontDatabase>
+#include <QPlainTextEdit>
+#include <streambuf>
+
+namespace {
+
+// Stream buffer that appends each line written to it to a text widget
+class PlainTextEditBuffer : public std::streambuf
+{
+public:
+    explicit PlainTextEditBuffer(QPlainTextEdit* edit) : edit_(edit) {}
+    ~PlainTextEditBuffer() override { sync(); }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (c != traits_type::eof()) {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        for (std::streamsize i = 0; i < n; ++i) {
+            if (s[i] == '\n') {
+                appendLine();
+            } else {
+                line_ += s[i];
+            }
+        }
+        return n;
+    }
+
+    int sync() override
+    {
+        if (!line_.empty()) {
+            appendLine();
+        }
+        return 0;
+    }
+
+private:
+    void appendLine()
+    {
+        edit_->appendPlainText(QString::fromStdString(line_));
+        line_.clear();
+    }
+
+    QPlainTextEdit* edit_;
+    std::string line_;
+};
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -26,11 +81,15 @@ void MainWindow::setupConnections()
     connect(ui->firstPassButton, &QPushButton::clicked, this, &MainWindow::onFirstPassClicked);
     connect(ui->secondPassButton, &QPushButton::clicked, this, &MainWindow::onSecondPassClicked);
     connect(ui->exampleComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onExampleChanged);
+
+    // The listing of the second pass is made from the source of the first one
+    connect(ui->sourceCodeTextEdit, &QTextEdit::textChanged, this, [this]() { ui->secondPassButton->setEnabled(false); });
 }
 
 void MainWindow::initializeDefaultContent()
 {
     ui->sourceCodeTextEdit->setPlainText(straightSample);
+    ui->listingTextEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
     
     // Initialize commands text edit with default commands
     QString commandsText;
@@ -52,33 +111,31 @@ void MainWindow::onFirstPassClicked()
         ui->secondSetupTable->clear();
         ui->firstPassTextEdit->clear();
         ui->secondPassTextEdit->clear();
+        ui->listingTextEdit->clear();
         ui->firstPassErrorsTextEdit->clear();
         ui->secondPassErrorsTextEdit->clear();
         
-        // Parse commands
+        // Parse commands; an unchanged table is taken from the cache without re-validation
         QString commandsText = ui->commandsTextEdit->toPlainText();
-        std::vector<std::vector<std::string>> commandLines = Parser::parseCode(commandsText.toStdString());
-        std::vector<Command> commands = Parser::textToCommands(commandsText.toStdString());
-        assembler.setAvailableCommands(commands);
+        assembler.setCommandTable(CommandTable::fromText(commandsText.toStdString()));
         
         // Clear TSI, TN, and Sections
         assembler.clearTSI();
         assembler.clearTN();
         assembler.clearSections();
         
-        // Parse source code
-        QString sourceText = ui->sourceCodeTextEdit->toPlainText();
-        std::vector<std::vector<std::string>> sourceLines = Parser::parseCode(sourceText.toStdString());
+        // Parse source code; its line numbers are kept for the listing of the second pass
+        std::string source = ui->sourceCodeTextEdit->toPlainText().toStdString();
+        std::vector<std::vector<std::string>> sourceLines = Parser::parseCode(source, &firstPassLineNumbers);
+        assembler.setLineNumbers(firstPassLineNumbers);
         
         // Get addressing mode from combo box
-        std::string addressingMode = "Straight";
+        AddressingMode addressingMode = AddressingMode::STRAIGHT;
         int selectedIndex = ui->exampleComboBox->currentIndex();
-        if (selectedIndex == 0) {
-            addressingMode = "Straight";
-        } else if (selectedIndex == 1) {
-            addressingMode = "Relative";
+        if (selectedIndex == 1) {
+            addressingMode = AddressingMode::RELATIVE;
         } else if (selectedIndex == 2) {
-            addressingMode = "Mixed";
+            addressingMode = AddressingMode::MIXED;
         }
         
         // First pass
@@ -91,16 +148,23 @@ void MainWindow::onFirstPassClicked()
         }
         ui->firstPassTextEdit->setPlainText(firstPassText);
         
-        // Display TSI with section and type
+        // Display TSI with section, type and the source lines of the symbol, definitions marked with '*'
         QString tsiText;
-        for (const auto& sym : assembler.getTSI()) {
+        std::vector<SymbolicName> symbols = assembler.getTSI();
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            const SymbolicName& sym = symbols[i];
             QString address = (sym.getAddress() >= 0) ? 
                             QString::number(sym.getAddress(), 16).toUpper().rightJustified(6, '0') : 
                             QString("");
+            QStringList sites;
+            for (const CrossReference::Site& site : assembler.getCrossReference().getSites(i)) {
+                sites << QString::number(site.line()) + (site.isDefinition() ? "*" : "");
+            }
             tsiText += QString::fromStdString(sym.getName()) + "\t" + 
                       address + "\t" +
                       QString::fromStdString(sym.getSection()) + "\t" +
-                      QString::fromStdString(sym.getType()) + "\n";
+                      QString::fromStdString(sym.getType()) + "\t" +
+                      sites.join(' ') + "\n";
         }
         ui->tsiTextEdit->setPlainText(tsiText);
         
@@ -117,6 +181,7 @@ void MainWindow::onSecondPassClicked()
 {
     ui->secondPassTextEdit->clear();
     ui->secondSetupTable->clear();
+    ui->listingTextEdit->clear();
     ui->secondPassErrorsTextEdit->clear();
     
     if (ui->firstPassTextEdit->toPlainText().isEmpty()) {
@@ -131,8 +196,15 @@ void MainWindow::onSecondPassClicked()
         QString firstPassText = ui->firstPassTextEdit->toPlainText();
         std::vector<std::vector<std::string>> firstPassLines = Parser::parseCode(firstPassText.toStdString());
         
-        // Second pass
+        // Second pass with the listing written to the widget line by line; the source
+        // is unchanged since the first pass, otherwise the button is disabled
+        std::string source = ui->sourceCodeTextEdit->toPlainText().toStdString();
+        PlainTextEditBuffer listingBuffer(ui->listingTextEdit);
+        std::ostream listingStream(&listingBuffer);
+        ListingWriter listing(listingStream, source, firstPassLineNumbers);
+        assembler.setListing(&listing);
         std::vector<std::string> secondPassResult = assembler.secondPass(firstPassLines);
+        assembler.setListing(nullptr);
         
         // Display results
         QString secondPassText;
@@ -151,8 +223,12 @@ void MainWindow::onSecondPassClicked()
         ui->secondSetupTable->setPlainText(tnText);
         
     } catch (const AssemblerException& e) {
+        assembler.setListing(nullptr);
+        ui->listingTextEdit->clear();
         ui->secondPassErrorsTextEdit->setPlainText("Ошибка: " + QString::fromStdString(e.what()));
     } catch (const std::exception& e) {
+        assembler.setListing(nullptr);
+        ui->listingTextEdit->clear();
         ui->secondPassErrorsTextEdit->setPlainText("Ошибка: " + QString::fromStdString(e.what()));
     }
 }
@@ -0,0 +1,12 @@
+#include "utils/cpufeatures.h"
+
+bool cpuHasAvx2()
+{
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    // Kernels with target attributes are built only by GCC and Clang
+    return false;
+#endif
+}
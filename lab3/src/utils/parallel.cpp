@@ -0,0 +1,56 @@
+#include "utils/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+size_t workerCount()
+{
+    // hardware_concurrency may return 0 when the value is unknown
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    size_t threadCount = std::min(count, workerCount());
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto run = [&]() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(run);
+    }
+    run();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,56 @@
+// LiteralCodec against the C library in the "C" locale: every byte value alone and at
+// every position of valid literals; exits with 1 on the first disagreement
+
+#include "assembler/literalcodec.h"
+#include <cctype>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const size_t MAX_LENGTH = 40;
+
+bool check(bool passed, const char* what, size_t length, size_t position, int value)
+{
+    if (!passed) {
+        std::fprintf(stderr, "FAILED: %s, length %zu, byte %zu = %d\n", what, length, position, value);
+    }
+    return passed;
+}
+
+std::string expectedHex(const std::string& text)
+{
+    std::string hex;
+    char digits[3];
+    for (char c : text) {
+        std::snprintf(digits, sizeof(digits), "%02X", static_cast<unsigned char>(c));
+        hex += digits;
+    }
+    return hex;
+}
+
+} // namespace
+
+int main()
+{
+    for (size_t length = 1; length <= MAX_LENGTH; ++length) {
+        for (size_t position = 0; position < length; ++position) {
+            for (int value = 0; value < 256; ++value) {
+                std::string printable(length, 'A');
+                std::string hex(length, 'f');
+                printable[position] = static_cast<char>(value);
+                hex[position] = static_cast<char>(value);
+
+                std::string encoded = "T ";
+                LiteralCodec::encodeHex(printable.data(), length, encoded);
+                if (!check(LiteralCodec::isPrintable(printable.data(), length) == (std::isprint(value) != 0), "isPrintable", length, position, value)
+                    || !check(LiteralCodec::isHexDigits(hex.data(), length) == (std::isxdigit(value) != 0), "isHexDigits", length, position, value)
+                    || !check(encoded == "T " + expectedHex(printable), "encodeHex", length, position, value)) {
+                    return 1;
+                }
+            }
+        }
+    }
+    std::printf("LiteralCodec: OK\n");
+    return 0;
+}
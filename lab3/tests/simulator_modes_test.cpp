@@ -0,0 +1,239 @@
+// Simulator with basic blocks and with the JIT against the plain interpreter, on
+// assembled programs and on random code that jumps into the middle of commands and
+// stores into itself. Every simulator runs with the same limits; after each run the
+// stop reason, registers, instruction pointer, instruction count, interrupt number
+// and memory digest must agree. Exits with 1 on the first disagreement.
+
+#include "assembler/assembler.h"
+#include "parser/parser.h"
+#include "simulator/simulator.h"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int RANDOM_PROGRAMS = 300;
+const int RUNS_PER_PROGRAM = 40;
+const uint32_t MAX_RUN = 5000;     // Instructions per run, at most
+const int LOAD_ADDRESS = 0x1000;
+
+struct Mode
+{
+    const char* name;
+    bool blocks;
+    bool jit;
+};
+
+// The first one is the reference
+const Mode MODES[] = {
+    { "interpreter", false, false },
+    { "blocks", true, false },
+    { "JIT", true, true },
+};
+const size_t MODE_COUNT = sizeof(MODES) / sizeof(MODES[0]);
+
+// Default commands, conditional jumps, SUB, NOP, HALT and SAVER2
+std::shared_ptr<const CommandTable> commandTable()
+{
+    static const std::shared_ptr<const CommandTable> table = std::make_shared<const CommandTable>(std::vector<Command>{
+        Command("JMP", 1, 4), Command("LOADR1", 2, 4), Command("LOADR2", 3, 4), Command("ADD", 4, 2),
+        Command("SAVER1", 5, 4), Command("INT", 6, 2), Command("JZ", 7, 4), Command("SUB", 8, 2),
+        Command("JNZ", 9, 4), Command("NOP", 10, 1), Command("HALT", 11, 1), Command("SAVER2", 12, 4)
+    });
+    return table;
+}
+
+const SemanticsTable& semantics()
+{
+    static const SemanticsTable table(*commandTable());
+    return table;
+}
+
+const char* reasonName(Simulator::StopReason reason)
+{
+    switch (reason) {
+    case Simulator::HALTED: return "HALTED";
+    case Simulator::INTERRUPTED: return "INTERRUPTED";
+    case Simulator::LIMIT_REACHED: return "LIMIT_REACHED";
+    case Simulator::FAULT: return "FAULT";
+    }
+    return "?";
+}
+
+// Everything the modes must agree on after a run
+std::string describe(const Simulator& simulator, Simulator::StopReason reason)
+{
+    char text[96];
+    std::snprintf(text, sizeof(text), "%s ip %06X count %llu int %u memory %016llX R", reasonName(reason),
+                  simulator.getInstructionPointer(), static_cast<unsigned long long>(simulator.getInstructionCount()),
+                  simulator.getInterruptNumber(), static_cast<unsigned long long>(simulator.getMemory().digest()));
+    std::string result = text;
+    for (int i = 0; i < Simulator::REGISTER_COUNT; ++i) {
+        std::snprintf(text, sizeof(text), " %06X", simulator.getRegister(i));
+        result += text;
+    }
+    return result;
+}
+
+// Runs the program set up by setup in every mode; compiled gets the most blocks the JIT held
+bool compareModes(const std::string& program, const std::function<void(Simulator&)>& setup, uint32_t seed, size_t& compiled)
+{
+    std::vector<std::unique_ptr<Simulator>> simulators;
+    for (const Mode& mode : MODES) {
+        simulators.emplace_back(new Simulator(semantics()));
+        simulators.back()->setBlockCacheEnabled(mode.blocks);
+        simulators.back()->setJitEnabled(mode.jit);
+        setup(*simulators.back());
+    }
+
+    std::mt19937 limits(seed);
+    for (int run = 0; run < RUNS_PER_PROGRAM; ++run) {
+        uint64_t limit = 1 + limits() % MAX_RUN;
+        Simulator::StopReason reference = simulators[0]->run(limit);
+        std::string expected = describe(*simulators[0], reference);
+
+        for (size_t i = 1; i < MODE_COUNT; ++i) {
+            std::string actual = describe(*simulators[i], simulators[i]->run(limit));
+            if (actual != expected) {
+                std::fprintf(stderr, "FAILED: %s, run %d of %llu instructions\n  %-11s %s\n  %-11s %s\n", program.c_str(), run,
+                             static_cast<unsigned long long>(limit), MODES[0].name, expected.c_str(), MODES[i].name, actual.c_str());
+                return false;
+            }
+            if (MODES[i].jit) {
+                compiled = std::max(compiled, simulators[i]->getCompiledBlockCount());
+            }
+        }
+
+        if (reference == Simulator::HALTED || reference == Simulator::FAULT) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool compareAssembled(const std::string& program, const std::string& source, size_t& compiled)
+{
+    Assembler assembler;
+    assembler.setCommandTable(commandTable());
+    ObjectProgram object = ObjectProgram::parse(assembler.assemble(Parser::parseCode(source), AddressingMode::MIXED));
+
+    return compareModes(program, [&object](Simulator& simulator) { simulator.load(object, LOAD_ADDRESS); }, 1, compiled);
+}
+
+// Random commands of the table with operands inside the code, a few bytes after it
+// or in the middle of a command; some programs cross a memory page
+bool compareRandom(int index, size_t& compiled)
+{
+    std::mt19937 random(static_cast<uint32_t>(index));
+    const std::vector<Command>& commands = commandTable()->getCommands();
+
+    const uint32_t base = LOAD_ADDRESS + (random() % 2) * (Memory::PAGE_SIZE - 6);
+    int count = 4 + random() % 40;
+    std::vector<const Command*> picked;
+    std::vector<uint32_t> starts;
+    uint32_t length = 0;
+    for (int i = 0; i < count; ++i) {
+        const Command* command = &commands[random() % commands.size()];
+        if (command->getName() == "INT" || command->getName() == "HALT") {
+            command = &commands[random() % commands.size()]; // Fewer stops
+        }
+        picked.push_back(command);
+        starts.push_back(base + length);
+        length += command->getLength();
+    }
+
+    const uint32_t data = base + length;
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < count; ++i) {
+        const Command& command = *picked[i];
+        int addressing = command.getLength() == 4 ? random() % 3 : 0;
+        bytes.push_back(static_cast<uint8_t>(command.getCode() * 4 + addressing));
+        if (command.getLength() == 2) {
+            bytes.push_back(command.getName() == "INT" ? random() % 256 : ((random() % 3) << 4) | (random() % 3));
+        } else if (command.getLength() == 4) {
+            uint32_t target;
+            if (command.getName() == "JMP" || command.getName() == "JZ" || command.getName() == "JNZ") {
+                target = starts[random() % count];
+            } else if (random() % 8 == 0) {
+                int other = random() % count;
+                target = starts[other] + 1 + random() % 3; // Into a command
+            } else {
+                target = data + random() % 30;
+            }
+            if (addressing == 2) {
+                target = (target - (base + static_cast<uint32_t>(bytes.size()) + 3)) & Memory::ADDRESS_MASK;
+            }
+            bytes.push_back(static_cast<uint8_t>(target >> 16));
+            bytes.push_back(static_cast<uint8_t>(target >> 8));
+            bytes.push_back(static_cast<uint8_t>(target));
+        }
+    }
+
+    uint8_t initial[32];
+    for (auto& byte : initial) {
+        byte = random() % 4 == 0 ? static_cast<uint8_t>(random()) : 0;
+    }
+
+    return compareModes("random program " + std::to_string(index), [&](Simulator& simulator) {
+        simulator.getMemory().writeBytes(base, bytes.data(), bytes.size());
+        simulator.getMemory().writeBytes(data, initial, sizeof(initial));
+        simulator.setCodeRange(base, data + sizeof(initial));
+        simulator.setInstructionPointer(base);
+    }, static_cast<uint32_t>(index), compiled);
+}
+
+} // namespace
+
+int main()
+{
+    size_t compiled = 0;
+
+    // Endless loop as in simulator_bench
+    std::string loop = "PROG START 0\nLOOP LOADR1 X\n     LOADR2 Y\n";
+    for (int i = 0; i < 8; ++i) {
+        loop += "     ADD R1 R2\n";
+    }
+    loop += "     SAVER1 X\n     JMP [LOOP]\nX    WORD 5\nY    WORD 1\n     END\n";
+
+    // Countdown with an interrupt, then a store that turns the next command into an illegal one.
+    // The parser takes a label only before the default commands.
+    const std::string countdown =
+        "PROG  START 0\n"
+        "      LOADR1 N\n"
+        "      LOADR2 ONE\n"
+        "LOOP  SUB R1 R2\n"
+        "      SAVER1 N\n"
+        "      JNZ [LOOP]\n"
+        "      INT 7\n"
+        "      LOADR1 N\n"
+        "      JZ DONE\n"
+        "      NOP\n"
+        "DONE  SAVER1 N\n"
+        "      SAVER2 [NEXT]\n"
+        "NEXT  ADD R1 R1\n"
+        "      HALT\n"
+        "N     WORD 20000\n"
+        "ONE   WORD 1\n"
+        "      END\n";
+
+    if (!compareAssembled("loop", loop, compiled) || !compareAssembled("countdown", countdown, compiled)) {
+        return 1;
+    }
+    for (int i = 0; i < RANDOM_PROGRAMS; ++i) {
+        if (!compareRandom(i, compiled)) {
+            return 1;
+        }
+    }
+
+    if (Simulator::isJitAvailable() && compiled == 0) {
+        std::fprintf(stderr, "FAILED: the JIT compiled no blocks\n");
+        return 1;
+    }
+    std::printf("Simulator modes: OK, %zu blocks compiled at most\n", compiled);
+    return 0;
+}
@@ -31,7 +31,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Initialize commands text box
     QStringList commandsText;
-    for (const Command& cmd : assembler.AvailibleCommands) {
+    for (const Command& cmd : assembler.AvailibleCommands->Commands) {
         commandsText.append(QString("%1 %2 %3").arg(cmd.Name, QString::number(cmd.Code, 16).toUpper(), QString::number(cmd.Length, 16).toUpper()));
     }
     ui->Commands_TextBox->setPlainText(commandsText.join("\n"));
@@ -61,7 +61,7 @@ void MainWindow::ProcessStep_Button_Click()
         QStringList tsiText;
         for (const SymbolicName& sn : assembler.TSI) {
             QStringList reqs;
-            for (int req : sn.AddressRequirements) {
+            for (int req : assembler.AddressRequirementsOf(sn)) {
                 reqs.append(QString::number(req, 16).toUpper().rightJustified(6, '0'));
             }
             QString reqsStr = reqs.isEmpty() ? "" : " " + reqs.join(" ");
@@ -109,7 +109,8 @@ void MainWindow::Reset()
         ui->BinaryCode_TextBox->clear();
         ui->Errors_TextBox->clear();
 
-        QList<CommandDto> newCommands = Parser::TextToCommandDtos(ui->Commands_TextBox->toPlainText());
+        // Edits of the source reset too; the unchanged command table comes from the cache
+        QSharedPointer<const CommandTable> newCommands = CommandTableCache::Get(ui->Commands_TextBox->toPlainText());
         QList<QList<QString>> sourceCode = Parser::ParseCode(ui->SourceCode_TextBox->toPlainText());
 
         assembler.Reset(sourceCode, newCommands);
@@ -148,7 +149,7 @@ void MainWindow::Pass_Button_Click()
             QStringList tsiText;
             for (const SymbolicName& sn : assembler.TSI) {
                 QStringList reqs;
-                for (int req : sn.AddressRequirements) {
+                for (int req : assembler.AddressRequirementsOf(sn)) {
                     reqs.append(QString::number(req, 16).toUpper().rightJustified(6, '0'));
                 }
                 QString reqsStr = reqs.isEmpty() ? "" : " " + reqs.join(" ");
@@ -7,6 +7,7 @@
 #include "assembler/Assembler.h"
 #include "helpers/Parser.h"
 #include "helpers/Comparer.h"
+#include "helpers/CommandTableCache.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -6,22 +6,24 @@
 const QStringList Assembler::AvailibleDirectives = {"START", "END", "WORD", "BYTE", "RESB", "RESW"};
 
 Assembler::Assembler()
-    : lineIterator(0), startAddress(0), endAddress(0), startFlag(false), endFlag(false), ip(0), AddressingMode("Straight")
+    : lineIterator(0), startAddress(0), endAddress(0), startFlag(false), endFlag(false), ip(0), freeRequirement(-1), AddressingMode("Straight")
 {
     // Default commands
-    AvailibleCommands.append(Command(CommandDto("JMP", "1", "4")));
-    AvailibleCommands.append(Command(CommandDto("LOADR1", "2", "4")));
-    AvailibleCommands.append(Command(CommandDto("LOADR2", "3", "4")));
-    AvailibleCommands.append(Command(CommandDto("ADD", "4", "2")));
-    AvailibleCommands.append(Command(CommandDto("SAVER1", "5", "4")));
-    AvailibleCommands.append(Command(CommandDto("INT", "6", "2")));
+    QList<Command> defaultCommands;
+    defaultCommands.append(Command(CommandDto("JMP", "1", "4")));
+    defaultCommands.append(Command(CommandDto("LOADR1", "2", "4")));
+    defaultCommands.append(Command(CommandDto("LOADR2", "3", "4")));
+    defaultCommands.append(Command(CommandDto("ADD", "4", "2")));
+    defaultCommands.append(Command(CommandDto("SAVER1", "5", "4")));
+    defaultCommands.append(Command(CommandDto("INT", "6", "2")));
+    AvailibleCommands = QSharedPointer<const CommandTable>(new CommandTable(defaultCommands));
 }
 
-void Assembler::SetAvailibleCommands(const QList<CommandDto>& newAvailibleCommandsDto)
+QSharedPointer<const CommandTable> Assembler::CreateCommandTable(const QList<CommandDto>& commandDtos)
 {
     // Try to convert
     QList<Command> newAvailibleCommands;
-    for (const CommandDto& dto : newAvailibleCommandsDto) {
+    for (const CommandDto& dto : commandDtos) {
         newAvailibleCommands.append(Command(dto));
     }
 
@@ -68,10 +70,25 @@ void Assembler::SetAvailibleCommands(const QList<CommandDto>& newAvailibleComman
         throw AssemblerException("Все коды команд должны быть уникальными");
     }
 
+    return QSharedPointer<const CommandTable>(new CommandTable(newAvailibleCommands));
+}
+
+void Assembler::SetAvailibleCommands(const QList<CommandDto>& newAvailibleCommandsDto)
+{
+    this->AvailibleCommands = CreateCommandTable(newAvailibleCommandsDto);
+}
+
+void Assembler::SetAvailibleCommands(const QSharedPointer<const CommandTable>& newAvailibleCommands)
+{
     this->AvailibleCommands = newAvailibleCommands;
 }
 
 void Assembler::Reset(const QList<QList<QString>>& sourceCode, const QList<CommandDto>& newCommands)
+{
+    Reset(sourceCode, CreateCommandTable(newCommands));
+}
+
+void Assembler::Reset(const QList<QList<QString>>& sourceCode, const QSharedPointer<const CommandTable>& newCommands)
 {
     SetAvailibleCommands(newCommands);
     ClearTSI();
@@ -386,13 +403,7 @@ bool Assembler::ProcessStep()
             CheckAddressRequirements();
         }
     } else if (IsCommand(codeLine.Command)) {
-        Command* command = nullptr;
-        for (int i = 0; i < AvailibleCommands.size(); i++) {
-            if (AvailibleCommands[i].Name.toUpper() == codeLine.Command.toUpper()) {
-                command = &AvailibleCommands[i];
-                break;
-            }
-        }
+        const Command* command = AvailibleCommands->Find(codeLine.Command);
 
         if (command == nullptr) {
             throw AssemblerException(QString("Команда не найдена: %1").arg(textLine));
@@ -492,7 +503,7 @@ bool Assembler::ProcessStep()
                 if (symbolicName == nullptr) {
                     SymbolicName newSymbolicName;
                     newSymbolicName.Name = label.toUpper();
-                    newSymbolicName.AddressRequirements.append(ip);
+                    AddAddressRequirement(newSymbolicName, ip);
                     TSI.append(newSymbolicName);
 
                     QString negativeOne = QString::number(0xFFFFFF, 16).toUpper().rightJustified(6, '0');
@@ -504,7 +515,7 @@ bool Assembler::ProcessStep()
                 } else {
                     if (symbolicName->Address == -1) {
                         // Undefined, push ip to AddressRequirements
-                        symbolicName->AddressRequirements.append(ip);
+                        AddAddressRequirement(*symbolicName, ip);
                         QString negativeOne = QString::number(0xFFFFFF, 16).toUpper().rightJustified(6, '0');
                         binaryCodeLine = QString("T %1 %2 %3%4").arg(
                             QString::number(ip, 16).toUpper().rightJustified(6, '0'),
@@ -539,7 +550,7 @@ bool Assembler::ProcessStep()
                 if (symbolicName == nullptr) {
                     SymbolicName newSymbolicName;
                     newSymbolicName.Name = codeLine.FirstOperand.toUpper();
-                    newSymbolicName.AddressRequirements.append(ip);
+                    AddAddressRequirement(newSymbolicName, ip);
                     TSI.append(newSymbolicName);
 
                     QString negativeOne = QString::number(0xFFFFFF, 16).toUpper().rightJustified(6, '0');
@@ -551,7 +562,7 @@ bool Assembler::ProcessStep()
                 } else {
                     if (symbolicName->Address == -1) {
                         // Undefined, push ip to AddressRequirements
-                        symbolicName->AddressRequirements.append(ip);
+                        AddAddressRequirement(*symbolicName, ip);
                         QString negativeOne = QString::number(0xFFFFFF, 16).toUpper().rightJustified(6, '0');
                         binaryCodeLine = QString("T %1 %2 %3%4").arg(
                             QString::number(ip, 16).toUpper().rightJustified(6, '0'),
@@ -615,7 +626,7 @@ bool Assembler::ProcessStep()
 void Assembler::CheckAddressRequirements()
 {
     for (const SymbolicName& sn : TSI) {
-        if (!sn.AddressRequirements.isEmpty()) {
+        if (sn.hasRequirements()) {
             throw AssemblerException("Не всем меткам было присвоено значение");
         }
     }
@@ -623,7 +634,8 @@ void Assembler::CheckAddressRequirements()
 
 void Assembler::ProvideAddresses(SymbolicName* symbolicName)
 {
-    for (int requirement : symbolicName->AddressRequirements) {
+    for (int r = symbolicName->FirstRequirement; r != -1; r = AddressRequirements[r].Next) {
+        int requirement = AddressRequirements[r].Address;
         // Find T lines (not H lines)
         for (int i = 0; i < BinaryCode.size(); i++) {
             QString line = BinaryCode[i];
@@ -694,12 +706,47 @@ void Assembler::ProvideAddresses(SymbolicName* symbolicName)
         }
     }
 
-    symbolicName->AddressRequirements.clear();
+    // The resolved chain goes to the front of the free list
+    if (symbolicName->FirstRequirement != -1) {
+        AddressRequirements[symbolicName->LastRequirement].Next = freeRequirement;
+        freeRequirement = symbolicName->FirstRequirement;
+    }
+    symbolicName->FirstRequirement = -1;
+    symbolicName->LastRequirement = -1;
+}
+
+void Assembler::AddAddressRequirement(SymbolicName& symbolicName, int address)
+{
+    int index = freeRequirement;
+    if (index != -1) {
+        freeRequirement = AddressRequirements[index].Next;
+        AddressRequirements[index] = { address, -1 };
+    } else {
+        index = AddressRequirements.size();
+        AddressRequirements.append({ address, -1 });
+    }
+    if (symbolicName.LastRequirement == -1) {
+        symbolicName.FirstRequirement = index;
+    } else {
+        AddressRequirements[symbolicName.LastRequirement].Next = index;
+    }
+    symbolicName.LastRequirement = index;
+}
+
+QList<int> Assembler::AddressRequirementsOf(const SymbolicName& symbolicName) const
+{
+    QList<int> result;
+    for (int r = symbolicName.FirstRequirement; r != -1; r = AddressRequirements[r].Next) {
+        result.append(AddressRequirements[r].Address);
+    }
+    return result;
 }
 
 void Assembler::ClearTSI()
 {
     TSI.clear();
+    AddressRequirements.clear();
+    freeRequirement = -1;
 }
 
 void Assembler::ClearTN()
@@ -711,16 +758,10 @@ bool Assembler::IsCommand(const QString& chunk) const
 {
     if (chunk.isEmpty()) return false;
 
-    QString upperChunk = chunk.toUpper();
-    for (const Command& cmd : AvailibleCommands) {
-        if (cmd.Name.toUpper() == upperChunk) {
-            return true;
-        }
-    }
-    return false;
+    return AvailibleCommands->Find(chunk) != nullptr;
 }
 
-bool Assembler::IsDirective(const QString& chunk) const
+bool Assembler::IsDirective(const QString& chunk)
 {
     if (chunk.isEmpty()) return false;
 
@@ -3,7 +3,10 @@
 
 #include <QString>
 #include <QList>
+#include <QVector>
+#include <QSharedPointer>
 #include "Command.h"
+#include "CommandTable.h"
 #include "CommandDto.h"
 #include "CodeLine.h"
 #include "SymbolicName.h"
@@ -15,16 +18,25 @@ public:
     QList<QList<QString>> SourceCode;
     QList<QString> BinaryCode;
     int lineIterator;
-    QList<Command> AvailibleCommands;
+    QSharedPointer<const CommandTable> AvailibleCommands;
     QList<SymbolicName> TSI;
+    QVector<AddressRequirement> AddressRequirements;  // Chains of SymbolicName::FirstRequirement and free entries
     QList<QString> TN;  // Таблица настройки
     QString AddressingMode;  // "Straight", "Relative", "Mixed"
 
     Assembler();
     void SetAvailibleCommands(const QList<CommandDto>& newAvailibleCommandsDto);
+    void SetAvailibleCommands(const QSharedPointer<const CommandTable>& newAvailibleCommands);
     void Reset(const QList<QList<QString>>& sourceCode, const QList<CommandDto>& newCommands);
+    void Reset(const QList<QList<QString>>& sourceCode, const QSharedPointer<const CommandTable>& newCommands);
     bool ProcessStep();
 
+    // Addresses waiting for the symbol, in the order they were met
+    QList<int> AddressRequirementsOf(const SymbolicName& symbolicName) const;
+
+    // Converts and validates commands; the table is used as is by SetAvailibleCommands and Reset
+    static QSharedPointer<const CommandTable> CreateCommandTable(const QList<CommandDto>& commandDtos);
+
 private:
     static const int maxAddress = 16777215;  // 2^24 - 1
     int startAddress;
@@ -32,13 +44,14 @@ private:
     bool startFlag;
     bool endFlag;
     int ip;
+    int freeRequirement;  // Chain of AddressRequirements entries of resolved symbols, -1 if empty
 
     static const QStringList AvailibleDirectives;
 
     void ClearTSI();
     void ClearTN();
     bool IsCommand(const QString& chunk) const;
-    bool IsDirective(const QString& chunk) const;
+    static bool IsDirective(const QString& chunk);
     bool IsLabel(const QString& chunk) const;
     bool IsRelativeLabel(const QString& chunk) const;
     static bool IsXString(const QString& chunk);
@@ -49,6 +62,7 @@ private:
     static QString ConvertToASCII(const QString& chunk);
     static void OverflowCheck(int value, const QString& textLine);
     CodeLine GetCodeLineFromSource(const QList<QString>& line);
+    void AddAddressRequirement(SymbolicName& symbolicName, int address);
     void CheckAddressRequirements();
     void ProvideAddresses(SymbolicName* symbolicName);
 };
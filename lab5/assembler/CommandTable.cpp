@@ -0,0 +1,16 @@
+#include "CommandTable.h"
+
+CommandTable::CommandTable(const QList<Command>& commands)
+    : Commands(commands)
+{
+    IndexByName.reserve(Commands.size());
+    for (int i = 0; i < Commands.size(); i++) {
+        IndexByName.insert(Commands[i].Name.toUpper(), i);
+    }
+}
+
+const Command* CommandTable::Find(const QString& name) const
+{
+    auto it = IndexByName.constFind(name.toUpper());
+    return it != IndexByName.constEnd() ? &Commands[it.value()] : nullptr;
+}
@@ -0,0 +1,21 @@
+#ifndef COMMANDTABLE_H
+#define COMMANDTABLE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "Command.h"
+
+// Validated commands with a lookup by name. Built by Assembler::CreateCommandTable
+// and shared between resets while the command text doesn't change.
+class CommandTable
+{
+public:
+    QList<Command> Commands;
+    QHash<QString, int> IndexByName;  // Upper-case name -> index in Commands
+
+    CommandTable(const QList<Command>& commands);
+    const Command* Find(const QString& name) const;
+};
+
+#endif // COMMANDTABLE_H
@@ -1,6 +1,6 @@
 #include "SymbolicName.h"
 
-SymbolicName::SymbolicName() : Address(-1)
+SymbolicName::SymbolicName() : Address(-1), FirstRequirement(-1), LastRequirement(-1)
 {
 }
 
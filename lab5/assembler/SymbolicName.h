@@ -2,17 +2,26 @@
 #define SYMBOLICNAME_H
 
 #include <QString>
-#include <QList>
+
+// Address of a command waiting for a symbol; requirements of all symbols
+// share one array and are chained by index
+struct AddressRequirement
+{
+    int Address;
+    int Next;  // -1 ends the chain
+};
 
 class SymbolicName
 {
 public:
     QString Name;
     int Address;  // -1 means undefined
-    QList<int> AddressRequirements;
+    int FirstRequirement;  // Indexes into Assembler::AddressRequirements, -1 if there are none
+    int LastRequirement;
 
     SymbolicName();
     bool isDefined() const { return Address != -1; }
+    bool hasRequirements() const { return FirstRequirement != -1; }
 };
 
 #endif // SYMBOLICNAME_H
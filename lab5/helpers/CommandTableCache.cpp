@@ -0,0 +1,39 @@
+#include "CommandTableCache.h"
+#include "Parser.h"
+#include "assembler/Assembler.h"
+#include <QHash>
+#include <QPair>
+
+QSharedPointer<const CommandTable> CommandTableCache::Get(const QString& text)
+{
+    static const int maxCachedTables = 16;
+    static QMultiHash<quint64, QPair<QString, QSharedPointer<const CommandTable>>> cache;
+
+    quint64 hash = ContentHash(text);
+    const auto entries = cache.values(hash);
+    for (const auto& entry : entries) {
+        if (entry.first == text) {
+            return entry.second;
+        }
+    }
+
+    // Invalid texts throw here and are not cached
+    QSharedPointer<const CommandTable> table = Assembler::CreateCommandTable(Parser::TextToCommandDtos(text));
+
+    if (cache.size() >= maxCachedTables) {
+        cache.clear();
+    }
+    cache.insert(hash, qMakePair(text, table));
+    return table;
+}
+
+quint64 CommandTableCache::ContentHash(const QString& text)
+{
+    // 64-bit FNV-1a over the UTF-16 code units
+    quint64 hash = 14695981039346656037ULL;
+    for (QChar c : text) {
+        hash ^= c.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,19 @@
+#ifndef COMMANDTABLECACHE_H
+#define COMMANDTABLECACHE_H
+
+#include <QString>
+#include <QSharedPointer>
+#include "assembler/CommandTable.h"
+
+// Command tables of the last seen texts, keyed by a hash of the text.
+// An unchanged text is neither parsed nor validated again.
+class CommandTableCache
+{
+public:
+    static QSharedPointer<const CommandTable> Get(const QString& text);
+
+private:
+    static quint64 ContentHash(const QString& text);
+};
+
+#endif // COMMANDTABLECACHE_H
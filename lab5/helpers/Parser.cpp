@@ -1,18 +1,103 @@
 #include "Parser.h"
 #include <QRegularExpression>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
 
-QList<QList<QString>> Parser::ParseCode(const QString& input)
+QList<QList<QString>> Parser::ParseCode(const QString& input, QList<int>* lineNumbers)
 {
-    QStringList lines = input.split(QRegularExpression("\\r?\\n"), Qt::SkipEmptyParts);
     QList<QList<QString>> result;
+    if (lineNumbers != nullptr) {
+        lineNumbers->clear();
+    }
+
+    int threadCount = QThread::idealThreadCount();
+    if (input.size() < parallelMinChars || threadCount < 2) {
+        ParseLines(QStringView(input), 1, result, lineNumbers);
+        return result;
+    }
+
+    // Chunks end right after a '\n', so no line is split; a few per thread even out their sizes
+    int chunkCount = threadCount * 4;
+    QList<qsizetype> bounds{ 0 };
+    for (int i = 1; i < chunkCount; ++i) {
+        qsizetype bound = qMax(bounds.last(), input.size() * i / chunkCount);
+        qsizetype lineEnd = input.indexOf('\n', bound);
+        if (lineEnd < 0) {
+            break;
+        }
+        if (lineEnd + 1 > bounds.last()) {
+            bounds.append(lineEnd + 1);
+        }
+    }
+    bounds.append(input.size());
+
+    // Every chunk numbers its lines from zero, then the numbers are shifted by the lines before it
+    int count = bounds.size() - 1;
+    QList<QList<QList<QString>>> chunkLines(count);
+    QList<QList<int>> chunkNumbers(count);
+    QList<int> chunkLineCounts(count);
+
+    // Tasks write only their own elements, the lists are detached before
+    QList<QList<QString>>* lines = chunkLines.data();
+    QList<int>* numbers = chunkNumbers.data();
+    int* lineCounts = chunkLineCounts.data();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < count; ++i) {
+        QStringView chunk = QStringView(input).mid(bounds[i], bounds[i + 1] - bounds[i]);
+        pool.start([=]() {
+            lineCounts[i] = ParseLines(chunk, 0, lines[i], lineNumbers != nullptr ? &numbers[i] : nullptr);
+        });
+    }
+    pool.waitForDone();
+
+    qsizetype total = 0;
+    for (const QList<QList<QString>>& chunk : chunkLines) {
+        total += chunk.size();
+    }
+    result.reserve(total);
+
+    // Moved, the token strings are not copied
+    int firstLine = 1;
+    for (int i = 0; i < count; ++i) {
+        for (QList<QString>& line : chunkLines[i]) {
+            result.append(std::move(line));
+        }
+        if (lineNumbers != nullptr) {
+            for (int number : chunkNumbers[i]) {
+                lineNumbers->append(firstLine + number);
+            }
+        }
+        firstLine += chunkLineCounts[i];
+    }
+
+    return result;
+}
+
+int Parser::ParseLines(QStringView input, int firstLine, QList<QList<QString>>& lines, QList<int>* lineNumbers)
+{
+    // Pattern to match words and C/X strings
+    QRegularExpression pattern("((?:[CX])\"[^\"]*(?:\"[^\"]*)*\"|\\S+)");
 
-    for (const QString& line : lines) {
-        QString lineWithoutTabs = line;
+    int lineNumber = firstLine;
+    qsizetype lineStart = 0;
+    while (lineStart < input.size()) {
+        qsizetype lineEnd = input.indexOf(u'\n', lineStart);
+        if (lineEnd < 0) {
+            lineEnd = input.size();
+        }
+
+        // Lines are split on \r?\n
+        QStringView line = input.mid(lineStart, lineEnd - lineStart);
+        if (line.endsWith(u'\r')) {
+            line.chop(1);
+        }
+
+        QString lineWithoutTabs = line.toString();
         lineWithoutTabs.replace('\t', ' ');
 
-        // Pattern to match words and C/X strings
-        QRegularExpression pattern("((?:[CX])\"[^\"]*(?:\"[^\"]*)*\"|\\S+)");
         QRegularExpressionMatchIterator matches = pattern.globalMatch(lineWithoutTabs);
 
         QList<QString> words;
@@ -25,11 +110,18 @@ QList<QList<QString>> Parser::ParseCode(const QString& input)
         }
 
         if (!words.isEmpty()) {
-            result.append(words);
+            lines.append(words);
+            if (lineNumbers != nullptr) {
+                lineNumbers->append(lineNumber);
+            }
         }
+
+        ++lineNumber;
+        lineStart = lineEnd + 1;
     }
 
-    return result;
+    // Number of source lines read
+    return lineNumber - firstLine;
 }
 
 QList<CommandDto> Parser::TextToCommandDtos(const QString& text)
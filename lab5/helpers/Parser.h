@@ -2,6 +2,7 @@
 #define PARSER_H
 
 #include <QString>
+#include <QStringView>
 #include <QList>
 #include "assembler/CommandDto.h"
 #include "assembler/AssemblerException.h"
@@ -9,8 +10,15 @@
 class Parser
 {
 public:
-    static QList<QList<QString>> ParseCode(const QString& input);
+    // Empty lines are skipped; lineNumbers, if given, receives the 1-based source line of every result line.
+    // Large inputs are split at line ends and tokenized on the threads of a pool.
+    static QList<QList<QString>> ParseCode(const QString& input, QList<int>* lineNumbers = nullptr);
     static QList<CommandDto> TextToCommandDtos(const QString& text);
+
+private:
+    static const int parallelMinChars = 1 << 20;  // Smaller sources are not worth the threads
+
+    static int ParseLines(QStringView input, int firstLine, QList<QList<QString>>& lines, QList<int>* lineNumbers);
 };
 
 #endif // PARSER_H